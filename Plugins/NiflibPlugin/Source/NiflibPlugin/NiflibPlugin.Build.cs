@@ -9,10 +9,6 @@ public class NiflibPlugin : ModuleRules
     {
         PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
 
-        PublicDefinitions.Add("NIFLIB_STATIC_LINK=1");
-        PublicIncludePaths.Add(Path.Combine(ModuleDirectory, "inc"));
-        PublicAdditionalLibraries.Add(Path.Combine(ModuleDirectory, "lib", "niflib_static.lib"));
-
         // PublicDependencyModuleNames.AddRange(new string[] { "Core" });
         // PrivateDependencyModuleNames.AddRange(new string[] { "CoreUObject", "Engine", "Slate", "SlateCore" });
 
@@ -30,11 +26,13 @@ public class NiflibPlugin : ModuleRules
 
         PublicDependencyModuleNames.AddRange(new string[] {
             "Core", "CoreUObject", "Engine",
-            "AssetTools", "MeshUtilities", "RenderCore"
+            "AssetTools", "MeshUtilities", "RenderCore",
+            "NiflibRuntime"             // niflib + FNiflibBridge
         });
 
         PrivateDependencyModuleNames.AddRange(new string[] {
             "UnrealEd",                 // factories / editor-only helpers
+            "AssetRegistry",            // skeleton lookup for .kf/.kfm import
             "MeshDescription",          // FMeshDescription & CreateVertexInstance_Internal
             "SkeletalMeshDescription",  // FSkeletalMeshAttributes
             "StaticMeshDescription",    // (often pulled in transitively; safe to add)
@@ -0,0 +1,215 @@
+#include "NifAnimationFactory.h"
+#include "NifSkeletalMeshFactory.h"
+#include "NifReader.h"
+#include "Animation/Skeleton.h"
+#include "Animation/AnimSequence.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+UNifAnimationFactory::UNifAnimationFactory()
+{
+    bEditorImport = true;
+    SupportedClass = UAnimSequence::StaticClass();
+    Formats.Add(TEXT("kf;Gamebryo KF animation"));
+    Formats.Add(TEXT("kfm;Gamebryo KFM action graph"));
+}
+
+bool UNifAnimationFactory::FactoryCanImport(const FString& Filename)
+{
+    return Filename.EndsWith(TEXT(".kf"), ESearchCase::IgnoreCase) ||
+        Filename.EndsWith(TEXT(".kfm"), ESearchCase::IgnoreCase);
+}
+
+void UNifAnimationFactory::SkeletonToNifBones(const USkeleton* Skeleton, TArray<FNifBone>& OutBones)
+{
+    OutBones.Reset();
+    if (!Skeleton) return;
+
+    const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+    const TArray<FTransform>& RefPose = RefSkeleton.GetRefBonePose();
+    OutBones.SetNum(RefSkeleton.GetNum());
+    for (int32 i = 0; i < OutBones.Num(); ++i)
+    {
+        OutBones[i].Name = RefSkeleton.GetBoneName(i).ToString();
+        OutBones[i].ParentIndex = RefSkeleton.GetParentIndex(i);
+        OutBones[i].BindPose = RefPose[i];
+    }
+}
+
+void UNifAnimationFactory::ExtractClips(const TArray<FString>& Files, const TArray<FNifBone>& Bones, float SampleRate, TArray<TArray<FNifAnimationData>>& OutClips)
+{
+    OutClips.Reset();
+    OutClips.SetNum(Files.Num());
+
+    // One file at a time: niflib's refcounts are shared, non-atomic state, so files cannot be read on several
+    // workers at once (the bridge lock would queue them anyway). Each file's tracks still resample in parallel.
+    for (int32 Index = 0; Index < Files.Num(); ++Index)
+    {
+        FNiflibBridge::ExtractAnimationsFromFile(Files[Index], Bones, SampleRate, OutClips[Index]);
+    }
+}
+
+USkeleton* UNifAnimationFactory::FindSkeletonForClips(const TArray<FNifAnimationData>& Clips, const FString& ModelHint)
+{
+    IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+    TArray<FAssetData> Skeletons;
+    AssetRegistry.GetAssetsByClass(USkeleton::StaticClass()->GetClassPathName(), Skeletons);
+
+    // The mesh factory names skeletons <Model>_Skeleton
+    if (!ModelHint.IsEmpty())
+    {
+        const FString Wanted = ModelHint + TEXT("_Skeleton");
+        for (const FAssetData& Asset : Skeletons)
+        {
+            if (Asset.AssetName.ToString().Equals(Wanted, ESearchCase::IgnoreCase))
+            {
+                return Cast<USkeleton>(Asset.GetAsset());
+            }
+        }
+    }
+
+    // Both sides canonicalized the way the bridge binds tracks to bones (TSet<FString> compares case-insensitively)
+    TSet<FString> TrackNames;
+    for (const FNifAnimationData& Clip : Clips)
+        for (const FNifKeyframeTrack& Track : Clip.Tracks)
+            TrackNames.Add(FNiflibBridge::CanonBoneName(Track.BoneName));
+    if (TrackNames.Num() == 0) return nullptr;
+
+    USkeleton* Best = nullptr;
+    int32 BestMatches = 0;
+    for (const FAssetData& Asset : Skeletons)
+    {
+        USkeleton* Candidate = Cast<USkeleton>(Asset.GetAsset());
+        if (!Candidate) continue;
+
+        const FReferenceSkeleton& RefSkeleton = Candidate->GetReferenceSkeleton();
+        int32 Matches = 0;
+        for (int32 BoneIdx = 0; BoneIdx < RefSkeleton.GetNum(); ++BoneIdx)
+        {
+            Matches += TrackNames.Contains(FNiflibBridge::CanonBoneName(RefSkeleton.GetBoneName(BoneIdx).ToString())) ? 1 : 0;
+        }
+        if (Matches > BestMatches)
+        {
+            Best = Candidate;
+            BestMatches = Matches;
+        }
+    }
+
+    if (Best)
+    {
+        UE_LOG(LogTemp, Log, TEXT("[NIF] Picked skeleton %s (%d of %d animated bones match)"),
+            *Best->GetPathName(), BestMatches, TrackNames.Num());
+    }
+    return Best;
+}
+
+UObject* UNifAnimationFactory::FactoryCreateFile(
+    UClass* InClass,
+    UObject* InParent,
+    FName InName,
+    EObjectFlags Flags,
+    const FString& Filename,
+    const TCHAR* Parms,
+    FFeedbackContext* Warn,
+    bool& bOutOperationCanceled)
+{
+    UE_LOG(LogTemp, Log, TEXT("[NIF] Importing animations %s"), *Filename);
+
+    const float SampleRate = FMath::Max(1.0f, AnimationSampleRate);
+
+    // A .kfm is a list of .kf actions; a .kf is its own single action
+    TArray<FString> KfFiles;
+    TArray<FString> ActionNames;
+    FString ModelHint;
+    if (Filename.EndsWith(TEXT(".kfm"), ESearchCase::IgnoreCase))
+    {
+        TArray<FNifKfmAction> Actions;
+        FString ModelPath;
+        if (!FNiflibBridge::ReadKfmActions(Filename, Actions, ModelPath))
+        {
+            bOutOperationCanceled = true;
+            return nullptr;
+        }
+        ModelHint = FPaths::GetBaseFilename(ModelPath);
+
+        for (const FNifKfmAction& Action : Actions)
+        {
+            if (!IFileManager::Get().FileExists(*Action.KfPath))
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF] KFM action '%s' missing file: %s"), *Action.Name, *Action.KfPath);
+                continue;
+            }
+            KfFiles.Add(Action.KfPath);
+            ActionNames.Add(Action.Name);
+        }
+    }
+    else
+    {
+        KfFiles.Add(Filename);
+        ActionNames.Add(FString());
+    }
+
+    if (KfFiles.Num() == 0)
+    {
+        bOutOperationCanceled = true;
+        return nullptr;
+    }
+
+    USkeleton* Skeleton = TargetSkeleton;
+    if (!Skeleton)
+    {
+        // Unbound probe of the first file, only to learn which bone names it animates
+        TArray<FNifAnimationData> Probe;
+        FNifReader::EnsureObjectRegistry();
+        FNiflibBridge::ExtractAnimationsFromFile(KfFiles[0], TArray<FNifBone>(), SampleRate, Probe);
+        Skeleton = FindSkeletonForClips(Probe, ModelHint);
+    }
+    if (!Skeleton)
+    {
+        UE_LOG(LogTemp, Error, TEXT("[NIF] No target skeleton for %s; set TargetSkeleton or import the model first."), *Filename);
+        bOutOperationCanceled = true;
+        return nullptr;
+    }
+
+    TArray<FNifBone> Bones;
+    SkeletonToNifBones(Skeleton, Bones);
+
+    const uint64 ExtractStartCycles = FPlatformTime::Cycles64();
+    TArray<TArray<FNifAnimationData>> ClipsPerFile;
+    ExtractClips(KfFiles, Bones, SampleRate, ClipsPerFile);
+    const double ExtractMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ExtractStartCycles);
+
+    const uint64 BuildStartCycles = FPlatformTime::Cycles64();
+    const FString BasePath = InParent->GetOutermost()->GetName();
+    UAnimSequence* First = nullptr;
+    int32 NumCreated = 0;
+    for (int32 FileIdx = 0; FileIdx < KfFiles.Num(); ++FileIdx)
+    {
+        TArray<FNifAnimationData>& Clips = ClipsPerFile[FileIdx];
+
+        // A single-clip action takes the action's name from the .kfm
+        if (Clips.Num() == 1 && !ActionNames[FileIdx].IsEmpty())
+        {
+            Clips[0].Name = ActionNames[FileIdx];
+        }
+
+        const TArray<UAnimSequence*> Sequences =
+            UNifSkeletalMeshFactory::CreateAnimSequences(Skeleton, nullptr, BasePath, InName.ToString(), Clips);
+        if (!First && Sequences.Num() > 0)
+        {
+            First = Sequences[0];
+        }
+        NumCreated += Sequences.Num();
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Animations from %d file(s): %d sequences, Extract=%.3f ms Build=%.3f ms"),
+        KfFiles.Num(), NumCreated, ExtractMs, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - BuildStartCycles));
+
+    if (!First)
+    {
+        bOutOperationCanceled = true;
+    }
+    return First;
+}
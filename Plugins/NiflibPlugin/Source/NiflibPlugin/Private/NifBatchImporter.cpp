@@ -0,0 +1,401 @@
+#include "NifBatchImporter.h"
+#include "NiflibBridge.h"
+#include "NifReader.h"
+#include "NifSkeletalMeshFactory.h"
+#include "NifAnimationFactory.h"
+#include "Engine/SkeletalMesh.h"
+#include "Animation/Skeleton.h"
+#include "Animation/AnimSequence.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "GPUSkinPublicDefs.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+    // One file's worker-side result, handed to the game thread for asset creation
+    struct FParsedNif
+    {
+        FString Path;
+        FString DestPath;
+        FString AssetName;
+        TArray<FNifMeshStreams> LODs;
+        TArray<FNifAnimationData> Anims;
+        uint64 CacheKey = 0;
+        bool bFromCache = false;
+        bool bOk = false;
+        double ReadSeconds = 0.0;
+        double ExtractSeconds = 0.0;
+    };
+
+    // Fill Out from the mesh cache if it holds this file. No niflib involved, so any number of these run at once.
+    static bool LoadCached(FParsedNif& Out, int32 MaxInfluences, float AnimSampleRate)
+    {
+        const uint64 ReadStartCycles = FPlatformTime::Cycles64();
+        Out.CacheKey = FNiflibBridge::GetMeshCacheKey(Out.Path, MaxInfluences, AnimSampleRate);
+        Out.bFromCache = FNiflibBridge::LoadCachedLODs(Out.CacheKey, Out.LODs, Out.Anims);
+        Out.bOk = Out.bFromCache;
+        Out.ReadSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - ReadStartCycles);
+        return Out.bFromCache;
+    }
+
+    // Read + extract one file through niflib. The bridge holds the niflib lock for each call, so files go one at a time.
+    static void ParseOne(FParsedNif& Out, int32 MaxInfluences, float AnimSampleRate)
+    {
+        const uint64 ReadStartCycles = FPlatformTime::Cycles64();
+        FNifScene* Scene = FNiflibBridge::OpenNifScene(Out.Path, true);
+        Out.ReadSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - ReadStartCycles);
+        if (!Scene)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF][Batch] Failed to read: %s"), *Out.Path);
+            return;
+        }
+        FNiflibBridge::ReleaseUnusedLODs(Scene, 0, FNiflibBridge::GetAuthoredLODCount(Scene));
+
+        const uint64 ExtractStartCycles = FPlatformTime::Cycles64();
+        Out.bOk = UNifSkeletalMeshFactory::ExtractImportLODs(Scene, MaxInfluences, Out.LODs);
+        if (Out.bOk && AnimSampleRate > 0.f)
+        {
+            FNiflibBridge::ExtractAnimations(Scene, Out.LODs[0].Bones, AnimSampleRate, Out.Anims);
+        }
+        FNiflibBridge::ReleaseNifScene(Scene);
+        Out.ExtractSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - ExtractStartCycles);
+
+        if (!Out.bOk)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF][Batch] Parse failed (LOD0): %s"), *Out.Path);
+        }
+    }
+
+    // niflib's refcounts are not thread-safe, so only the cache lookups and writes fan out across workers; the misses
+    // are parsed one after another on the pool thread. Either way the chunk overlaps the game thread's asset builds.
+    static TFuture<void> LaunchChunk(TArray<FParsedNif>& Chunk, int32 MaxInfluences, float AnimSampleRate)
+    {
+        return Async(EAsyncExecution::ThreadPool, [&Chunk, MaxInfluences, AnimSampleRate]()
+        {
+            ParallelFor(Chunk.Num(), [&Chunk, MaxInfluences, AnimSampleRate](int32 Index)
+            {
+                LoadCached(Chunk[Index], MaxInfluences, AnimSampleRate);
+            });
+
+            for (FParsedNif& Parsed : Chunk)
+            {
+                if (!Parsed.bFromCache)
+                {
+                    ParseOne(Parsed, MaxInfluences, AnimSampleRate);
+                }
+            }
+
+            ParallelFor(Chunk.Num(), [&Chunk](int32 Index)
+            {
+                const FParsedNif& Parsed = Chunk[Index];
+                if (Parsed.bOk && !Parsed.bFromCache)
+                {
+                    FNiflibBridge::StoreCachedLODs(Parsed.CacheKey, Parsed.LODs, Parsed.Anims);
+                }
+            });
+        });
+    }
+
+    // Mirror the source sub-folder of File (relative to SourceRoot) under DestPath
+    static FString MirrorDestPath(const FString& File, const FString& SourceRoot, const FString& DestPath)
+    {
+        FString RelDir = FPaths::GetPath(File);
+        if (!SourceRoot.IsEmpty() && FPaths::MakePathRelativeTo(RelDir, *(SourceRoot / TEXT(""))) && !RelDir.IsEmpty() && !RelDir.StartsWith(TEXT("..")))
+        {
+            return DestPath / RelDir;
+        }
+        return DestPath;
+    }
+
+    static bool SaveAssetPackage(UObject* Asset)
+    {
+        UPackage* Package = Asset->GetOutermost();
+        const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+        FSavePackageArgs SaveArgs;
+        SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+        SaveArgs.SaveFlags = SAVE_NoError;
+        return UPackage::SavePackage(Package, Asset, *Filename, SaveArgs);
+    }
+}
+
+namespace FNifBatchImporter
+{
+    TArray<FString> GatherFiles(const FString& Folder, bool bRecursive, const TCHAR* Wildcard)
+    {
+        TArray<FString> Files;
+        if (bRecursive)
+        {
+            IFileManager::Get().FindFilesRecursive(Files, *Folder, Wildcard, true, false);
+        }
+        else
+        {
+            IFileManager::Get().FindFiles(Files, *(Folder / Wildcard), true, false);
+            for (FString& File : Files)
+                File = Folder / File;
+        }
+        Files.Sort();
+        return Files;
+    }
+
+    FNifBatchImportStats ImportFiles(const TArray<FString>& Files, const FNifBatchImportOptions& Options, const FString& SourceRoot)
+    {
+        check(IsInGameThread());
+
+        FNifBatchImportStats Stats;
+        Stats.NumFiles = Files.Num();
+        if (Files.Num() == 0) return Stats;
+
+        const uint64 WallStartCycles = FPlatformTime::Cycles64();
+
+        // niflib fills its type registry lazily on first read; do that before the first chunk is timed
+        FNifReader::EnsureObjectRegistry();
+
+        const int32 MaxInfluences = FMath::Clamp(Options.MaxBoneInfluences, 1, (int32)MAX_TOTAL_INFLUENCES);
+        const float AnimSampleRate = Options.bImportAnimations ? FMath::Max(1.0f, Options.AnimationSampleRate) : 0.0f;
+        const int32 ChunkSize = FMath::Max(1, Options.ChunkSize);
+        const int32 NumChunks = FMath::DivideAndRoundUp(Files.Num(), ChunkSize);
+
+        // Two chunk buffers: the pool fills one while the game thread builds assets from the other
+        TArray<FParsedNif> Chunks[2];
+        auto FillChunk = [&](int32 ChunkIdx, TArray<FParsedNif>& Chunk)
+        {
+            Chunk.Reset();
+            const int32 First = ChunkIdx * ChunkSize;
+            const int32 Last = FMath::Min(First + ChunkSize, Files.Num());
+            for (int32 i = First; i < Last; ++i)
+            {
+                FParsedNif& Entry = Chunk.AddDefaulted_GetRef();
+                Entry.Path = Files[i];
+                Entry.AssetName = FPaths::GetBaseFilename(Files[i]);
+
+                Entry.DestPath = MirrorDestPath(Files[i], SourceRoot, Options.DestPath);
+            }
+        };
+
+        FillChunk(0, Chunks[0]);
+        TFuture<void> Pending = LaunchChunk(Chunks[0], MaxInfluences, AnimSampleRate);
+
+        for (int32 ChunkIdx = 0; ChunkIdx < NumChunks; ++ChunkIdx)
+        {
+            Pending.Wait();
+            TArray<FParsedNif>& Ready = Chunks[ChunkIdx & 1];
+
+            if (ChunkIdx + 1 < NumChunks)
+            {
+                TArray<FParsedNif>& Next = Chunks[(ChunkIdx + 1) & 1];
+                FillChunk(ChunkIdx + 1, Next);
+                Pending = LaunchChunk(Next, MaxInfluences, AnimSampleRate);
+            }
+
+            for (FParsedNif& Parsed : Ready)
+            {
+                Stats.ReadSeconds += Parsed.ReadSeconds;
+                Stats.ExtractSeconds += Parsed.ExtractSeconds;
+
+                if (!Parsed.bOk)
+                {
+                    ++Stats.NumFailed;
+                    continue;
+                }
+
+                const uint64 BuildStartCycles = FPlatformTime::Cycles64();
+                USkeletalMesh* SkeletalMesh = UNifSkeletalMeshFactory::CreateSkeletalMeshFromLODs(Parsed.DestPath, Parsed.AssetName, Parsed.LODs);
+                TArray<UAnimSequence*> Sequences;
+                if (SkeletalMesh)
+                {
+                    Sequences = UNifSkeletalMeshFactory::CreateAnimSequences(SkeletalMesh->GetSkeleton(), SkeletalMesh, Parsed.DestPath, Parsed.AssetName, Parsed.Anims);
+                }
+                const double BuildSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - BuildStartCycles);
+                Stats.BuildSeconds += BuildSeconds;
+
+                // Streams and clips are no longer needed once the assets exist
+                Parsed.LODs.Empty();
+                Parsed.Anims.Empty();
+
+                if (!SkeletalMesh)
+                {
+                    UE_LOG(LogTemp, Error, TEXT("[NIF][Batch] Build failed: %s"), *Parsed.Path);
+                    ++Stats.NumFailed;
+                    continue;
+                }
+
+                double SaveSeconds = 0.0;
+                if (Options.bSavePackages)
+                {
+                    const uint64 SaveStartCycles = FPlatformTime::Cycles64();
+                    bool bSaved = SaveAssetPackage(SkeletalMesh);
+                    if (USkeleton* Skeleton = SkeletalMesh->GetSkeleton())
+                        bSaved &= SaveAssetPackage(Skeleton);
+                    for (UAnimSequence* Sequence : Sequences)
+                        bSaved &= SaveAssetPackage(Sequence);
+                    SaveSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - SaveStartCycles);
+                    Stats.SaveSeconds += SaveSeconds;
+
+                    if (!bSaved)
+                        UE_LOG(LogTemp, Warning, TEXT("[NIF][Batch] Save failed: %s"), *SkeletalMesh->GetPathName());
+                }
+
+                ++Stats.NumImported;
+                UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Batch file '%s' Read=%.3f ms Extract=%.3f ms Build=%.3f ms Save=%.3f ms"),
+                    *Parsed.AssetName, Parsed.ReadSeconds * 1000.0, Parsed.ExtractSeconds * 1000.0,
+                    BuildSeconds * 1000.0, SaveSeconds * 1000.0);
+            }
+            Ready.Empty();
+        }
+
+        Stats.WallSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - WallStartCycles);
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Batch: %d files (%d imported, %d failed) in %.2f s wall | Read=%.2f s Extract=%.2f s (pool) Build=%.2f s Save=%.2f s (game thread)"),
+            Stats.NumFiles, Stats.NumImported, Stats.NumFailed, Stats.WallSeconds,
+            Stats.ReadSeconds, Stats.ExtractSeconds, Stats.BuildSeconds, Stats.SaveSeconds);
+
+        return Stats;
+    }
+
+    FNifBatchImportStats ImportFolder(const FString& Folder, bool bRecursive, const FNifBatchImportOptions& Options)
+    {
+        const TArray<FString> Files = GatherFiles(Folder, bRecursive);
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Batch] %d .nif files under %s"), Files.Num(), *Folder);
+        return ImportFiles(Files, Options, Folder);
+    }
+
+    FNifBatchImportStats ImportAnimationFiles(const TArray<FString>& Files, USkeleton* Skeleton, const FNifBatchImportOptions& Options, const FString& SourceRoot)
+    {
+        check(IsInGameThread());
+
+        FNifBatchImportStats Stats;
+        Stats.NumFiles = Files.Num();
+        if (Files.Num() == 0 || !Skeleton) return Stats;
+
+        const uint64 WallStartCycles = FPlatformTime::Cycles64();
+
+        TArray<FNifBone> Bones;
+        UNifAnimationFactory::SkeletonToNifBones(Skeleton, Bones);
+
+        const float SampleRate = FMath::Max(1.0f, Options.AnimationSampleRate);
+        const int32 ChunkSize = FMath::Max(1, Options.ChunkSize);
+
+        // Resampled clips are dense, so only one chunk of them is held at a time
+        TArray<FString> Chunk;
+        TArray<TArray<FNifAnimationData>> ClipsPerFile;
+        for (int32 First = 0; First < Files.Num(); First += ChunkSize)
+        {
+            const int32 Last = FMath::Min(First + ChunkSize, Files.Num());
+            Chunk.Reset();
+            for (int32 i = First; i < Last; ++i)
+                Chunk.Add(Files[i]);
+
+            const uint64 ExtractStartCycles = FPlatformTime::Cycles64();
+            UNifAnimationFactory::ExtractClips(Chunk, Bones, SampleRate, ClipsPerFile);
+            Stats.ExtractSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - ExtractStartCycles);
+
+            for (int32 i = 0; i < Chunk.Num(); ++i)
+            {
+                if (ClipsPerFile[i].Num() == 0)
+                {
+                    UE_LOG(LogTemp, Error, TEXT("[NIF][Batch] No animation clips in %s"), *Chunk[i]);
+                    ++Stats.NumFailed;
+                    continue;
+                }
+
+                const uint64 BuildStartCycles = FPlatformTime::Cycles64();
+                const TArray<UAnimSequence*> Sequences = UNifSkeletalMeshFactory::CreateAnimSequences(
+                    Skeleton, nullptr, MirrorDestPath(Chunk[i], SourceRoot, Options.DestPath), FPaths::GetBaseFilename(Chunk[i]), ClipsPerFile[i]);
+                Stats.BuildSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - BuildStartCycles);
+
+                if (Options.bSavePackages)
+                {
+                    const uint64 SaveStartCycles = FPlatformTime::Cycles64();
+                    for (UAnimSequence* Sequence : Sequences)
+                    {
+                        if (!SaveAssetPackage(Sequence))
+                            UE_LOG(LogTemp, Warning, TEXT("[NIF][Batch] Save failed: %s"), *Sequence->GetPathName());
+                    }
+                    Stats.SaveSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - SaveStartCycles);
+                }
+
+                ++Stats.NumImported;
+            }
+            ClipsPerFile.Reset();
+        }
+
+        Stats.WallSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - WallStartCycles);
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Batch animations: %d files (%d imported, %d failed) in %.2f s wall | Extract=%.2f s Build=%.2f s Save=%.2f s (game thread)"),
+            Stats.NumFiles, Stats.NumImported, Stats.NumFailed, Stats.WallSeconds,
+            Stats.ExtractSeconds, Stats.BuildSeconds, Stats.SaveSeconds);
+
+        return Stats;
+    }
+}
+
+// Nif.ImportFolder <SourceDir> [DestPath] [-norecurse] [-save] [-noanims] [-influences=N] [-chunk=N]
+static FAutoConsoleCommand GNifImportFolderCommand(
+    TEXT("Nif.ImportFolder"),
+    TEXT("Batch import every .nif under a folder as Skeletal Meshes. Usage: Nif.ImportFolder <SourceDir> [DestPath] [-norecurse] [-save] [-noanims] [-influences=N] [-chunk=N]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF][Batch] Usage: Nif.ImportFolder <SourceDir> [DestPath] [-norecurse] [-save] [-noanims] [-influences=N] [-chunk=N]"));
+            return;
+        }
+
+        FNifBatchImportOptions Options;
+        bool bRecursive = true;
+        for (int32 i = 1; i < Args.Num(); ++i)
+        {
+            const FString& Arg = Args[i];
+            if (Arg.Equals(TEXT("-norecurse"), ESearchCase::IgnoreCase)) bRecursive = false;
+            else if (Arg.Equals(TEXT("-save"), ESearchCase::IgnoreCase)) Options.bSavePackages = true;
+            else if (Arg.Equals(TEXT("-noanims"), ESearchCase::IgnoreCase)) Options.bImportAnimations = false;
+            else if (Arg.StartsWith(TEXT("-influences="), ESearchCase::IgnoreCase)) Options.MaxBoneInfluences = FCString::Atoi(*Arg.Mid(12));
+            else if (Arg.StartsWith(TEXT("-chunk="), ESearchCase::IgnoreCase)) Options.ChunkSize = FCString::Atoi(*Arg.Mid(7));
+            else if (Arg.StartsWith(TEXT("/"))) Options.DestPath = Arg;
+        }
+
+        FNifBatchImporter::ImportFolder(Args[0], bRecursive, Options);
+    }));
+
+// Nif.ImportAnimFolder <SourceDir> <SkeletonObjectPath> [DestPath] [-norecurse] [-save] [-rate=Hz] [-chunk=N]
+static FAutoConsoleCommand GNifImportAnimFolderCommand(
+    TEXT("Nif.ImportAnimFolder"),
+    TEXT("Batch import every .kf under a folder as AnimSequences on an existing skeleton. Usage: Nif.ImportAnimFolder <SourceDir> <SkeletonObjectPath> [DestPath] [-norecurse] [-save] [-rate=Hz] [-chunk=N]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 2)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF][Batch] Usage: Nif.ImportAnimFolder <SourceDir> <SkeletonObjectPath> [DestPath] [-norecurse] [-save] [-rate=Hz] [-chunk=N]"));
+            return;
+        }
+
+        USkeleton* Skeleton = LoadObject<USkeleton>(nullptr, *Args[1]);
+        if (!Skeleton)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF][Batch] Skeleton not found: %s"), *Args[1]);
+            return;
+        }
+
+        FNifBatchImportOptions Options;
+        bool bRecursive = true;
+        for (int32 i = 2; i < Args.Num(); ++i)
+        {
+            const FString& Arg = Args[i];
+            if (Arg.Equals(TEXT("-norecurse"), ESearchCase::IgnoreCase)) bRecursive = false;
+            else if (Arg.Equals(TEXT("-save"), ESearchCase::IgnoreCase)) Options.bSavePackages = true;
+            else if (Arg.StartsWith(TEXT("-rate="), ESearchCase::IgnoreCase)) Options.AnimationSampleRate = FCString::Atof(*Arg.Mid(6));
+            else if (Arg.StartsWith(TEXT("-chunk="), ESearchCase::IgnoreCase)) Options.ChunkSize = FCString::Atoi(*Arg.Mid(7));
+            else if (Arg.StartsWith(TEXT("/"))) Options.DestPath = Arg;
+        }
+
+        const TArray<FString> Files = FNifBatchImporter::GatherFiles(Args[0], bRecursive, TEXT("*.kf"));
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Batch] %d .kf files under %s"), Files.Num(), *Args[0]);
+        FNifBatchImporter::ImportAnimationFiles(Files, Skeleton, Options, Args[0]);
+    }));
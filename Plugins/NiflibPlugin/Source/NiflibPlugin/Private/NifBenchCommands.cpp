@@ -0,0 +1,501 @@
+#include "NifBatchImporter.h"
+#include "NiflibBridge.h"
+#include "NifReader.h"
+#include "NifTypeIndex.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+#include "Math/RandomStream.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include <atomic>
+
+#include <niflib.h>
+#include <obj/NiNode.h>
+#include <obj/NiLODNode.h>
+#include <obj/NiAVObject.h>
+#include <obj/NiGeometry.h>
+#include <obj/NiTriShape.h>
+#include <obj/NiTriShapeData.h>
+
+using namespace Niflib;
+
+// Benchmarks and stress tests for the NIF pipeline. Editor-only; everything here goes through NiflibRuntime's public API
+// and takes FNifReader::GetNiflibLock() wherever it touches niflib objects itself.
+
+namespace
+{
+    static FORCEINLINE FVector3f ToUE(const Vector3& v)
+    {
+        return FVector3f((float)v.x, (float)v.y, (float)v.z);
+    }
+    static FORCEINLINE FVector2f ToUV(const TexCoord& uv)
+    {
+        return FVector2f((float)uv.u, (float)uv.v);   // the bridge keeps V as authored
+    }
+
+    // One file the way the importers take it: streaming open, LOD0 streams, release. Returns a CRC of the output (0 = failed).
+    static uint32 StressParseOne(const FString& Path)
+    {
+        FNifScene* Scene = FNiflibBridge::OpenNifScene(Path, true);
+        if (!Scene) return 0;
+        FNiflibBridge::ReleaseUnusedLODs(Scene, 0, 1);
+
+        FNifMeshStreams Mesh;
+        FNifAnimationData Anim;
+        const bool bOk = FNiflibBridge::ExtractLODStreams(Scene, 0, Mesh, Anim);
+        FNiflibBridge::ReleaseNifScene(Scene);
+        if (!bOk) return 0;
+
+        uint32 Crc = FCrc::MemCrc32(Mesh.Positions.GetData(), Mesh.Positions.Num() * Mesh.Positions.GetTypeSize(), 1);
+        Crc = FCrc::MemCrc32(Mesh.Normals.GetData(), Mesh.Normals.Num() * Mesh.Normals.GetTypeSize(), Crc);
+        Crc = FCrc::MemCrc32(Mesh.Indices.GetData(), Mesh.Indices.Num() * Mesh.Indices.GetTypeSize(), Crc);
+        Crc = FCrc::MemCrc32(Mesh.BoneIndices.GetData(), Mesh.BoneIndices.Num() * Mesh.BoneIndices.GetTypeSize(), Crc);
+        Crc = FCrc::MemCrc32(Mesh.BoneWeights.GetData(), Mesh.BoneWeights.Num() * Mesh.BoneWeights.GetTypeSize(), Crc);
+        return Crc != 0 ? Crc : 1;
+    }
+}
+
+// Nif.StressParse <SourceDir> [Passes] [-norecurse]: parse every .nif once serially for reference output, then
+// Passes more times from every worker thread at once. The bridge serializes niflib work on its lock, so this checks
+// that callers on many threads get the serial output and leak no scenes; it is not a throughput test.
+static FAutoConsoleCommand GNifStressParseCommand(
+    TEXT("Nif.StressParse"),
+    TEXT("Parse every .nif under a folder from many threads and compare against a serial pass. Usage: Nif.StressParse <SourceDir> [Passes] [-norecurse]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] Usage: Nif.StressParse <SourceDir> [Passes] [-norecurse]"));
+            return;
+        }
+
+        int32 Passes = 4;
+        bool bRecursive = true;
+        for (int32 i = 1; i < Args.Num(); ++i)
+        {
+            if (Args[i].Equals(TEXT("-norecurse"), ESearchCase::IgnoreCase)) bRecursive = false;
+            else Passes = FMath::Max(1, FCString::Atoi(*Args[i]));
+        }
+
+        const TArray<FString> Files = FNifBatchImporter::GatherFiles(Args[0], bRecursive);
+        if (Files.Num() == 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] No .nif files under %s"), *Args[0]);
+            return;
+        }
+
+        const int32 LiveScenesBefore = FNiflibBridge::GetNumLiveScenes();
+
+        TArray<uint32> Reference;
+        Reference.SetNumZeroed(Files.Num());
+        const uint64 SerialStartCycles = FPlatformTime::Cycles64();
+        for (int32 i = 0; i < Files.Num(); ++i)
+        {
+            Reference[i] = StressParseOne(Files[i]);
+        }
+        const double SerialMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SerialStartCycles);
+
+        // Interleave the passes so the same file is often requested from several threads at once
+        std::atomic<int32> NumMismatches{ 0 };
+        const uint64 ThreadedStartCycles = FPlatformTime::Cycles64();
+        ParallelFor(Files.Num() * Passes, [&](int32 Job)
+        {
+            const int32 FileIdx = Job % Files.Num();
+            const uint32 Crc = StressParseOne(Files[FileIdx]);
+            if (Crc != Reference[FileIdx])
+            {
+                ++NumMismatches;
+                UE_LOG(LogTemp, Error, TEXT("[NIF] Stress: %s decoded to %08x, serial pass gave %08x"), *Files[FileIdx], Crc, Reference[FileIdx]);
+            }
+        }, EParallelForFlags::Unbalanced);
+        const double ThreadedMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ThreadedStartCycles);
+
+        int32 NumFailed = 0;
+        for (uint32 Crc : Reference)
+        {
+            NumFailed += (Crc == 0) ? 1 : 0;
+        }
+        const int32 LeakedScenes = FNiflibBridge::GetNumLiveScenes() - LiveScenesBefore;
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Stress parse: %d files (%d unreadable) x %d passes from %d workers: Serial=%.1f ms/pass Threaded=%.1f ms/pass Mismatches=%d LeakedScenes=%d"),
+            Files.Num(), NumFailed, Passes, FTaskGraphInterface::Get().GetNumWorkerThreads(),
+            SerialMs, ThreadedMs / Passes, NumMismatches.load(), LeakedScenes);
+    }));
+
+// Nif.BenchSceneLifetime <File> [Iterations]: open (read + index) and teardown of one file's block graph, and what
+// the caller still pays for teardown when it is deferred to the pool
+static FAutoConsoleCommand GNifBenchSceneLifetimeCommand(
+    TEXT("Nif.BenchSceneLifetime"),
+    TEXT("Time parsing and freeing one .nif's block graph, inline and deferred. Usage: Nif.BenchSceneLifetime <File> [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] Usage: Nif.BenchSceneLifetime <File> [Iterations]"));
+            return;
+        }
+        const int32 Iterations = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10);
+
+        double OpenMs = 0.0, InlineMs = 0.0, DeferredMs = 0.0;
+        int32 NumBlocks = 0;
+        for (int32 It = 0; It < Iterations; ++It)
+        {
+            for (int32 Mode = 0; Mode < 2; ++Mode)
+            {
+                const uint64 OpenStartCycles = FPlatformTime::Cycles64();
+                FNifScene* Scene = FNiflibBridge::OpenNifScene(Args[0]);
+                if (!Scene)
+                {
+                    UE_LOG(LogTemp, Error, TEXT("[NIF] Could not open %s"), *Args[0]);
+                    return;
+                }
+                OpenMs += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - OpenStartCycles);
+                NumBlocks = FNiflibBridge::GetNumBlocks(Scene);
+
+                const uint64 ReleaseStartCycles = FPlatformTime::Cycles64();
+                if (Mode == 0)
+                {
+                    FNiflibBridge::ReleaseNifScene(Scene);
+                    InlineMs += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ReleaseStartCycles);
+                }
+                else
+                {
+                    FNiflibBridge::ReleaseNifSceneDeferred(Scene);
+                    DeferredMs += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ReleaseStartCycles);
+                    FNiflibBridge::FlushDeferredReleases();   // keep the next open's timing clean
+                }
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Scene lifetime, %s (%d blocks) x %d: Open=%.3f ms Teardown inline=%.3f ms deferred=%.3f ms (caller side)"),
+            *FPaths::GetCleanFilename(Args[0]), NumBlocks, Iterations, OpenMs / (2 * Iterations), InlineMs / Iterations, DeferredMs / Iterations);
+    }));
+
+// Nif.BenchTypeChecks <File> [Iterations]: the scene index walk's per-node cast chain over every block of one file,
+// through niflib's DynamicCast (base_type walk + Ref) and through NifCast (interval test, borrowed pointer). Holds the
+// niflib lock throughout, since DynamicCast makes Refs.
+static FAutoConsoleCommand GNifBenchTypeChecksCommand(
+    TEXT("Nif.BenchTypeChecks"),
+    TEXT("Time niflib's DynamicCast against NifCast over one .nif's blocks. Usage: Nif.BenchTypeChecks <File> [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] Usage: Nif.BenchTypeChecks <File> [Iterations]"));
+            return;
+        }
+        const int32 Iterations = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100);
+
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        NifInfo Info;
+        const std::vector<NiObjectRef> Blocks = FNifReader::ReadNifListMapped(Args[0], Info);
+        if (Blocks.empty())
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Could not open %s"), *Args[0]);
+            return;
+        }
+
+        int64 DynamicHits = 0;
+        const uint64 DynamicStartCycles = FPlatformTime::Cycles64();
+        for (int32 It = 0; It < Iterations; ++It)
+        {
+            for (const NiObjectRef& Obj : Blocks)
+            {
+                DynamicHits += DynamicCast<NiLODNode>(Obj) ? 1 : 0;
+                DynamicHits += DynamicCast<NiNode>(Obj) ? 1 : 0;
+                DynamicHits += DynamicCast<NiTriShape>(Obj) ? 1 : 0;
+                DynamicHits += DynamicCast<NiGeometry>(Obj) ? 1 : 0;
+                DynamicHits += DynamicCast<NiAVObject>(Obj) ? 1 : 0;
+            }
+        }
+        const double DynamicMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - DynamicStartCycles) / Iterations;
+
+        int64 IndexHits = 0;
+        const uint64 IndexStartCycles = FPlatformTime::Cycles64();
+        for (int32 It = 0; It < Iterations; ++It)
+        {
+            for (const NiObjectRef& Obj : Blocks)
+            {
+                IndexHits += NifCast<NiLODNode>(Obj) ? 1 : 0;
+                IndexHits += NifCast<NiNode>(Obj) ? 1 : 0;
+                IndexHits += NifCast<NiTriShape>(Obj) ? 1 : 0;
+                IndexHits += NifCast<NiGeometry>(Obj) ? 1 : 0;
+                IndexHits += NifCast<NiAVObject>(Obj) ? 1 : 0;
+            }
+        }
+        const double IndexMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - IndexStartCycles) / Iterations;
+
+        if (DynamicHits != IndexHits)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Type checks disagree: DynamicCast matched %lld, NifCast %lld"), DynamicHits, IndexHits);
+        }
+        const int32 NumChecks = (int32)Blocks.size() * 5;
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Type checks, %s (%d checks) x %d: DynamicCast=%.3f ms NifCast=%.3f ms (%.2fx, %.1f ns/check)"),
+            *FPaths::GetCleanFilename(Args[0]), NumChecks, Iterations, DynamicMs, IndexMs,
+            DynamicMs / FMath::Max(IndexMs, 1e-6), IndexMs * 1.0e6 / FMath::Max(NumChecks, 1));
+    }));
+
+// Nif.BenchReader <SourceDir> [Passes] [-norecurse]: niflib's std::ifstream reader against the mapped reader (serial
+// and block-parallel) on the same files; the block graph is freed outside the timed region. Holds the niflib lock
+// throughout, as every reader here creates and frees niflib objects.
+static FAutoConsoleCommand GNifBenchReaderCommand(
+    TEXT("Nif.BenchReader"),
+    TEXT("Time the istream, mapped and mapped block-parallel readers over every .nif under a folder. Usage: Nif.BenchReader <SourceDir> [Passes] [-norecurse]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] Usage: Nif.BenchReader <SourceDir> [Passes] [-norecurse]"));
+            return;
+        }
+
+        int32 Passes = 3;
+        bool bRecursive = true;
+        for (int32 i = 1; i < Args.Num(); ++i)
+        {
+            if (Args[i].Equals(TEXT("-norecurse"), ESearchCase::IgnoreCase)) bRecursive = false;
+            else Passes = FMath::Max(1, FCString::Atoi(*Args[i]));
+        }
+
+        const TArray<FString> Files = FNifBatchImporter::GatherFiles(Args[0], bRecursive);
+        if (Files.Num() == 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] No .nif files under %s"), *Args[0]);
+            return;
+        }
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        FNifReader::EnsureObjectRegistry();
+
+        enum EMode { Istream, Mapped, MappedParallel, NumModes };
+        static const TCHAR* const ModeNames[NumModes] = { TEXT("istream"), TEXT("mapped"), TEXT("mapped+parallel") };
+        const auto ReadOnce = [](const FString& Path, int32 Mode) -> std::vector<NiObjectRef>
+        {
+            NifInfo Info;
+            try
+            {
+                if (Mode == Istream) return ReadNifList(std::string(TCHAR_TO_UTF8(*Path)), &Info);
+                return FNifReader::ReadNifListMapped(Path, Info, Mode == MappedParallel);
+            }
+            catch (const std::exception& Ex)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF] %s: %s read failed: %s"), *Path, ModeNames[Mode], UTF8_TO_TCHAR(Ex.what()));
+                return std::vector<NiObjectRef>();
+            }
+        };
+
+        // Warm the OS file cache once so no mode pays for the first disk read
+        int64 TotalBytes = 0;
+        for (const FString& File : Files)
+        {
+            TotalBytes += IFileManager::Get().FileSize(*File);
+            ReadOnce(File, Istream);
+        }
+
+        double ModeMs[NumModes] = {};
+        int32 NumMismatches = 0;
+        for (int32 Pass = 0; Pass < Passes; ++Pass)
+        {
+            for (const FString& File : Files)
+            {
+                size_t NumBlocks[NumModes] = {};
+                for (int32 Mode = 0; Mode < NumModes; ++Mode)
+                {
+                    const uint64 StartCycles = FPlatformTime::Cycles64();
+                    std::vector<NiObjectRef> Blocks = ReadOnce(File, Mode);
+                    ModeMs[Mode] += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+                    NumBlocks[Mode] = Blocks.size();
+                }
+                if (NumBlocks[Mapped] != NumBlocks[Istream] || NumBlocks[MappedParallel] != NumBlocks[Istream])
+                {
+                    ++NumMismatches;
+                }
+            }
+        }
+
+        const double TotalMB = (double)TotalBytes * Passes / (1024.0 * 1024.0);
+        for (int32 Mode = 0; Mode < NumModes; ++Mode)
+        {
+            UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Reader %s: %d files (%.1f MB) x %d passes in %.1f ms (%.1f MB/s, %.2fx istream)"),
+                ModeNames[Mode], Files.Num(), (double)TotalBytes / (1024.0 * 1024.0), Passes, ModeMs[Mode],
+                TotalMB / FMath::Max(ModeMs[Mode] / 1000.0, 1e-9), ModeMs[Istream] / FMath::Max(ModeMs[Mode], 1e-6));
+        }
+        if (NumMismatches > 0)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Reader bench: %d file reads disagreed on the block count"), NumMismatches);
+        }
+    }));
+
+// Nif.BenchGeoStreams [MaxVerts] [Iterations]: the original per-vertex getter loop (GetVertices()/GetNormals() copy
+// the whole stream on every call) against reading NiGeometryData's arrays in place once per shape, as the bridge's
+// fill does, on synthetic NiTriShapeData of growing size
+static FAutoConsoleCommand GNifBenchGeoStreamsCommand(
+    TEXT("Nif.BenchGeoStreams"),
+    TEXT("Time per-vertex NiGeometryData getters against the per-shape stream fetch at 64..MaxVerts vertices. Usage: Nif.BenchGeoStreams [MaxVerts] [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        const int32 MaxVerts = FMath::Clamp(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 8192, 64, 65535);
+        const int32 Iterations = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20);
+
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        FRandomStream Rng(0x4E4946);
+        const FTransform WorldXf(FRotator(30.0, 45.0, 60.0), FVector(12.0, -3.0, 7.5), FVector(1.5));
+
+        for (int32 NumVerts = 64; NumVerts <= MaxVerts; NumVerts *= 4)
+        {
+            std::vector<Vector3> Positions(NumVerts), Normals(NumVerts);
+            std::vector<TexCoord> UVs(NumVerts);
+            for (int32 i = 0; i < NumVerts; ++i)
+            {
+                Positions[i] = Vector3(Rng.FRandRange(-100.f, 100.f), Rng.FRandRange(-100.f, 100.f), Rng.FRandRange(-100.f, 100.f));
+                const FVector N = Rng.GetUnitVector();
+                Normals[i] = Vector3((float)N.X, (float)N.Y, (float)N.Z);
+                UVs[i] = TexCoord(Rng.FRand(), Rng.FRand());
+            }
+
+            NiTriShapeDataRef Data = new NiTriShapeData;
+            Data->SetVertices(Positions);
+            Data->SetNormals(Normals);
+            Data->SetUVSetCount(1);
+            Data->SetUVSet(0, UVs);
+
+            TArray<FVector3f> GetterPos, GetterNrm, StreamPos, StreamNrm;
+            TArray<FVector2f> GetterUV, StreamUV;
+            GetterPos.SetNumUninitialized(NumVerts);
+            GetterNrm.SetNumUninitialized(NumVerts);
+            GetterUV.SetNumUninitialized(NumVerts);
+            StreamPos.SetNumUninitialized(NumVerts);
+            StreamNrm.SetNumUninitialized(NumVerts);
+            StreamUV.SetNumUninitialized(NumVerts);
+
+            // The getter loop is quadratic in the vertex count; scale its iterations down so large shapes finish
+            const int32 GetterIterations = FMath::Max(1, (int32)((int64)Iterations * 1024 / NumVerts));
+
+            // Reference: the loop AppendGeometryFromGeo used before the streams were fetched once per shape
+            const uint64 GetterStartCycles = FPlatformTime::Cycles64();
+            for (int32 It = 0; It < GetterIterations; ++It)
+            {
+                const std::vector<TexCoord> UVSet0 = Data->GetUVSet(0);
+                for (int32 i = 0; i < NumVerts; ++i)
+                {
+                    GetterPos[i] = (FVector3f)WorldXf.TransformPosition(FVector(ToUE(Data->GetVertices()[i])));
+                    if (!Data->GetNormals().empty() && i < (int32)Data->GetNormals().size())
+                    {
+                        GetterNrm[i] = (FVector3f)WorldXf.TransformVectorNoScale(FVector(ToUE(Data->GetNormals()[i]))).GetSafeNormal();
+                    }
+                    GetterUV[i] = (i < (int32)UVSet0.size()) ? ToUV(UVSet0[i]) : FVector2f(0, 0);
+                }
+            }
+            const double GetterMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - GetterStartCycles) / GetterIterations;
+
+            const uint64 StreamStartCycles = FPlatformTime::Cycles64();
+            for (int32 It = 0; It < Iterations; ++It)
+            {
+                const std::vector<Vector3>& Vertices = Data->GetVerticesView();
+                const std::vector<Vector3>& NormalsView = Data->GetNormalsView();
+                const std::vector<std::vector<TexCoord>>& UVSets = Data->GetUVSetsView();
+                const int32 NumNormals = FMath::Min(NumVerts, (int32)NormalsView.size());
+                const int32 NumUV0 = UVSets.empty() ? 0 : FMath::Min(NumVerts, (int32)UVSets[0].size());
+                for (int32 i = 0; i < NumVerts; ++i)
+                {
+                    StreamPos[i] = (FVector3f)WorldXf.TransformPosition(FVector(ToUE(Vertices[i])));
+                    if (i < NumNormals)
+                    {
+                        StreamNrm[i] = (FVector3f)WorldXf.TransformVectorNoScale(FVector(ToUE(NormalsView[i]))).GetSafeNormal();
+                    }
+                    StreamUV[i] = (i < NumUV0) ? ToUV(UVSets[0][i]) : FVector2f(0, 0);
+                }
+            }
+            const double StreamMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StreamStartCycles) / Iterations;
+
+            const bool bSame = FMemory::Memcmp(GetterPos.GetData(), StreamPos.GetData(), NumVerts * sizeof(FVector3f)) == 0
+                && FMemory::Memcmp(GetterNrm.GetData(), StreamNrm.GetData(), NumVerts * sizeof(FVector3f)) == 0
+                && FMemory::Memcmp(GetterUV.GetData(), StreamUV.GetData(), NumVerts * sizeof(FVector2f)) == 0;
+
+            UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Geo streams, %d verts: Getters=%.3f ms (%.1f ns/vert, x%d) Fetched=%.3f ms (%.1f ns/vert, x%d) %.2fx%s"),
+                NumVerts, GetterMs, GetterMs * 1.0e6 / NumVerts, GetterIterations, StreamMs, StreamMs * 1.0e6 / NumVerts, Iterations,
+                GetterMs / FMath::Max(StreamMs, 1e-6), bSame ? TEXT("") : TEXT(" OUTPUT MISMATCH"));
+        }
+    }));
+
+// Nif.BenchExtractAllocs <File> [LOD] [Iterations]: one file through the importer path (streaming open,
+// ExtractLODStreams, release) with a trace bookmark before each stage. The bridge tags its allocations per stage
+// (Nif/Open, Nif/Decode, Nif/Extract, Nif/Release, on the task threads too), so with the editor started with
+// -llm -trace=memalloc,memtag,bookmark, Memory Insights shows each stage's allocation count and bytes between the
+// bookmarks. The log only carries stage times and the process's resident memory.
+static FAutoConsoleCommand GNifBenchExtractAllocsCommand(
+    TEXT("Nif.BenchExtractAllocs"),
+    TEXT("Run one .nif through OpenNifScene, ExtractLODStreams and ReleaseNifScene between trace bookmarks, for Memory Insights (-llm -trace=memalloc,memtag,bookmark). Usage: Nif.BenchExtractAllocs <File> [LOD] [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] Usage: Nif.BenchExtractAllocs <File> [LOD] [Iterations]"));
+            return;
+        }
+        const int32 LOD = FMath::Max(0, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 0);
+        const int32 Iterations = FMath::Max(1, Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 5);
+        const FString Name = FPaths::GetCleanFilename(Args[0]);
+
+        // Registry setup and first-touch statics are one-off costs; keep them before the first bookmark
+        FNifScene* WarmScene = FNiflibBridge::OpenNifScene(Args[0]);
+        if (!WarmScene)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Could not open %s"), *Args[0]);
+            return;
+        }
+        FNiflibBridge::ReleaseNifScene(WarmScene);
+
+        enum EStage { Open, Extract, Release, NumStages };
+        static const TCHAR* const StageNames[NumStages] = { TEXT("Open"), TEXT("ExtractLODStreams"), TEXT("Release") };
+        double StageMs[NumStages] = {};
+        int32 NumVerts = 0, NumTris = 0;
+        bool bOk = true;
+
+        uint64 StageStartCycles = 0;
+        const auto BeginStage = [&](EStage Stage, int32 It)
+        {
+            TRACE_BOOKMARK(TEXT("Nif %s %s #%d"), StageNames[Stage], *Name, It);
+            StageStartCycles = FPlatformTime::Cycles64();
+        };
+        const auto EndStage = [&](EStage Stage)
+        {
+            StageMs[Stage] += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StageStartCycles);
+        };
+
+        for (int32 It = 0; It < Iterations && bOk; ++It)
+        {
+            FNifMeshStreams Mesh;
+            FNifAnimationData Anim;
+
+            BeginStage(Open, It);
+            FNifScene* Scene = FNiflibBridge::OpenNifScene(Args[0], true);
+            if (Scene)
+            {
+                FNiflibBridge::ReleaseUnusedLODs(Scene, LOD, 1);
+            }
+            EndStage(Open);
+            BeginStage(Extract, It);
+            bOk = Scene && FNiflibBridge::ExtractLODStreams(Scene, LOD, Mesh, Anim);
+            EndStage(Extract);
+            BeginStage(Release, It);
+            FNiflibBridge::ReleaseNifScene(Scene);
+            EndStage(Release);
+            TRACE_BOOKMARK(TEXT("Nif done %s #%d"), *Name, It);
+
+            NumVerts = Mesh.Positions.Num();
+            NumTris = Mesh.Indices.Num() / 3;
+        }
+        if (!bOk)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] %s: LOD%d extraction failed"), *Args[0], LOD);
+            return;
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Mem] %s LOD%d (%d verts, %d tris) x %d: Open=%.3f ms Extract=%.3f ms Release=%.3f ms; per-stage allocations are in the memalloc trace"),
+            *Name, LOD, NumVerts, NumTris, Iterations, StageMs[Open] / Iterations, StageMs[Extract] / Iterations, StageMs[Release] / Iterations);
+        FNiflibBridge::LogMemoryStage(Args[0], TEXT("after BenchExtractAllocs"));
+    }));
@@ -1,5 +1,6 @@
 ﻿#include "NifSkeletalMeshFactory.h"
 #include "NiflibBridge.h"
+#include "NifVertexKernels.h"
 #include "Engine/SkeletalMesh.h"
 #include "Animation/Skeleton.h"
 #include "ReferenceSkeleton.h"
@@ -16,6 +17,9 @@
 #include "MeshDescription.h"
 #include "SkeletalMeshAttributes.h"
 #include "BoneWeights.h"
+#include "GPUSkinPublicDefs.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/AnimData/IAnimationDataController.h"
 
 UNifSkeletalMeshFactory::UNifSkeletalMeshFactory()
 {
@@ -38,133 +42,87 @@ static UPackage* MakeAssetPackage(const FString& BasePath, const FString& AssetN
     return CreatePackage(*PackageName);
 }
 
-// Small helper to build one LOD from FNifMeshData into the SkeletalMesh
+// Small helper to build one LOD from FNifMeshStreams into the SkeletalMesh
 static bool BuildOneLOD(
     int32 LODIndex,
-    const FNifMeshData& Mesh,
+    const FNifMeshStreams& Mesh,
     USkeletalMesh* SkeletalMesh,
     const FReferenceSkeleton& RefSkeleton,
     bool& bOutHasImportNormals)
 {
     using namespace SkeletalMeshImportData;
 
-    // Points
-    TArray<FVector3f> Points;
-    Points.Reserve(Mesh.Vertices.Num());
+    // Points (the position stream is consumed as-is)
+    const TArray<FVector3f>& Points = Mesh.Positions;
     bOutHasImportNormals = false;
 
-    for (const FNifVertex& V : Mesh.Vertices)
+    for (const FVector3f& N : Mesh.Normals)
     {
-        Points.Add(V.Position);
-        if (!bOutHasImportNormals && !V.Normal.IsNearlyZero(1e-6f))
+        if (!N.IsNearlyZero(1e-6f))
+        {
             bOutHasImportNormals = true;
+            break;
+        }
     }
 
     // Wedges/Faces
+    const int32 NumFaces = Mesh.NumFaces();
     TArray<FMeshWedge> Wedges;
-    Wedges.Reserve(Mesh.Faces.Num() * 3);
+    Wedges.Reserve(NumFaces * 3);
     TArray<FMeshFace> Faces;
-    Faces.Reserve(Mesh.Faces.Num());
+    Faces.Reserve(NumFaces);
 
-    for (const FNifFace& F : Mesh.Faces)
+    for (int32 FaceIdx = 0; FaceIdx < NumFaces; ++FaceIdx)
     {
         FMeshFace Face{};
-        Face.MeshMaterialIndex = (uint16)F.MaterialIndex;
+        Face.MeshMaterialIndex = (uint16)Mesh.FaceMaterials[FaceIdx];
         Face.SmoothingGroups = 1;
 
         for (int32 c = 0; c < 3; ++c)
         {
-            const int32 VertIdx = F.Indices[c];
-            const FNifVertex& V = Mesh.Vertices[VertIdx];
+            const int32 VertIdx = Mesh.Indices[FaceIdx * 3 + c];
 
             FMeshWedge W{};
             W.iVertex = (uint32)VertIdx;
-            W.UVs[0] = V.UV;
-            W.Color = FColor::White;
+            W.UVs[0] = Mesh.UVs[VertIdx];
+            W.Color = Mesh.Colors[VertIdx];
 
             Face.iWedge[c] = (uint32)Wedges.Add(W);
-            Face.TangentX[c] = FVector3f::ZeroVector;
-            Face.TangentY[c] = FVector3f::ZeroVector;
-            Face.TangentZ[c] = bOutHasImportNormals ? V.Normal : FVector3f::ZeroVector;
+            Face.TangentX[c] = Mesh.Tangents[VertIdx];
+            Face.TangentY[c] = Mesh.Bitangents[VertIdx];
+            Face.TangentZ[c] = bOutHasImportNormals ? Mesh.Normals[VertIdx] : FVector3f::ZeroVector;
         }
         Faces.Add(Face);
     }
 
-    // Influences
+    // Influences: the bridge's NormalizeInfluences already left every row valid, strongest-first and normalized,
+    // so the flat list BuildSkeletalMesh consumes is sized exactly and written in one pass. Bones the reference
+    // skeleton did not take (duplicate names) are the only entries left to skip.
+    const int32 K = Mesh.MaxInfluences;
+    const int32 NumBones = RefSkeleton.GetRawBoneNum();
+    const int32* SlotBones = Mesh.BoneIndices.GetData();
+    const float* SlotWeights = Mesh.BoneWeights.GetData();
     TArray<FVertInfluence> Influences;
-    Influences.Reserve(Mesh.Vertices.Num() * 4);
-    for (int32 VertIndex = 0; VertIndex < Mesh.Vertices.Num(); ++VertIndex)
-    {
-        for (const FNifVertexInfluence& Inf : Mesh.Vertices[VertIndex].Influences)
-        {
-            if (Inf.BoneIndex < 0) continue;
-            FVertInfluence R{};
-            R.Weight = Inf.Weight;
-            R.VertIndex = VertIndex;
-            R.BoneIndex = (FBoneIndexType)Inf.BoneIndex;
-            Influences.Add(R);
-        }
-    }
-
-    UE_LOG(LogTemp, Log, TEXT("[NIF] LOD%d Pre-normalization: Wedges=%d, Faces=%d, Influences=%d"),
-        LODIndex, Wedges.Num(), Faces.Num(), Influences.Num());
-
-    // Normalize influences (engine utility)
-    int32 ZeroInfluenceVertexCount = 0;
+    Influences.SetNumUninitialized(FNifVertexKernels::CountInfluences(SlotBones, Points.Num(), K, NumBones));
+    FVertInfluence* OutInfluence = Influences.GetData();
+    int32 DroppedInfluences = 0;
+    for (int32 Slot = 0; Slot < Points.Num() * K; ++Slot)
     {
-        FSkeletalMeshImportData Temp;
-        for (const FVertInfluence& v : Influences)
+        const int32 Bone = SlotBones[Slot];
+        if ((uint32)Bone >= (uint32)NumBones)
         {
-            SkeletalMeshImportData::FRawBoneInfluence Raw{};
-            Raw.Weight = v.Weight;
-            Raw.VertexIndex = v.VertIndex;
-            Raw.BoneIndex = v.BoneIndex;
-            Temp.Influences.Add(Raw);
+            DroppedInfluences += (Bone != INDEX_NONE) ? 1 : 0;
+            continue;
         }
 
-        SkeletalMeshImportUtils::ProcessImportMeshInfluences(Temp, SkeletalMesh->GetName());
-
-        // Count zero-influence verts
-        TArray<int32> InfCount;
-        InfCount.Init(0, Points.Num());
-        for (const auto& Raw : Temp.Influences)
-            if (Raw.VertexIndex >= 0 && Raw.VertexIndex < InfCount.Num())
-                ++InfCount[Raw.VertexIndex];
-
-        for (int32 i = 0; i < InfCount.Num(); ++i)
-            if (InfCount[i] == 0) ++ZeroInfluenceVertexCount;
-
-        Influences.Empty(Temp.Influences.Num());
-        for (const auto& Raw : Temp.Influences)
-        {
-            FVertInfluence v{};
-            v.Weight = Raw.Weight;
-            v.VertIndex = Raw.VertexIndex;
-            v.BoneIndex = (FBoneIndexType)Raw.BoneIndex;
-            Influences.Add(v);
-        }
+        OutInfluence->Weight = SlotWeights[Slot];
+        OutInfluence->VertIndex = (uint32)(Slot / K);
+        OutInfluence->BoneIndex = (FBoneIndexType)Bone;
+        ++OutInfluence;
     }
 
-    UE_LOG(LogTemp, Log, TEXT("[NIF] LOD%d Post-normalization: Influences=%d, ZeroInfluenceVerts=%d"),
-        LODIndex, Influences.Num(), ZeroInfluenceVertexCount);
-
-    // Validate influences
-    {
-        const uint32 NumPointsU = static_cast<uint32>(Points.Num());
-        const uint32 NumBonesU = static_cast<uint32>(RefSkeleton.GetRawBoneNum());
-
-        for (int32 i = Influences.Num() - 1; i >= 0; --i)
-        {
-            const FVertInfluence& I = Influences[i];
-            const bool bBadVert = (static_cast<uint32>(I.VertIndex) >= NumPointsU);
-            const bool bBadBone = (static_cast<uint32>(I.BoneIndex) >= NumBonesU);
-            const bool bBadW = (!FMath::IsFinite(I.Weight) || I.Weight <= 0.f);
-            if (bBadVert || bBadBone || bBadW)
-            {
-                Influences.RemoveAtSwap(i, 1, false);
-            }
-        }
-    }
+    UE_LOG(LogTemp, Log, TEXT("[NIF] LOD%d Wedges=%d, Faces=%d, Influences=%d (K=%d, dropped=%d)"),
+        LODIndex, Wedges.Num(), Faces.Num(), Influences.Num(), K, DroppedInfluences);
 
     // Identity map
     TArray<int32> PointToOriginalMap;
@@ -279,37 +237,105 @@ static bool BuildOneLOD(
     return true;
 }
 
-UObject* UNifSkeletalMeshFactory::FactoryCreateFile(
-    UClass* InClass,
-    UObject* InParent,
-    FName InName,
-    EObjectFlags Flags,
-    const FString& Filename,
-    const TCHAR* Parms,
-    FFeedbackContext* Warn,
-    bool& bOutOperationCanceled)
+bool UNifSkeletalMeshFactory::ExtractImportLODs(const FNifScene* Scene, int32 MaxInfluences, TArray<FNifMeshStreams>& OutLODs)
 {
-    UE_LOG(LogTemp, Log, TEXT("[NIF] Importing %s"), *Filename);
+    OutLODs.Reset();
 
-    // First: build LOD0 (explicit LOD request = 0)
-    FNifMeshData MeshLOD0;
+    // First: LOD0 (explicit LOD request = 0)
+    FNifMeshStreams& MeshLOD0 = OutLODs.AddDefaulted_GetRef();
+    MeshLOD0.MaxInfluences = MaxInfluences;
     FNifAnimationData Anim0;
-    if (!FNiflibBridge::ParseNifFileWithLOD(Filename, 0, MeshLOD0, Anim0))
+    if (!FNiflibBridge::ExtractLODStreams(Scene, 0, MeshLOD0, Anim0))
     {
-        UE_LOG(LogTemp, Error, TEXT("[NIF] Parse failed (LOD0): %s"), *Filename);
-        bOutOperationCanceled = true;
-        return nullptr;
+        OutLODs.Reset();
+        return false;
     }
 
     UE_LOG(LogTemp, Log, TEXT("[NIF] Raw LOD0 counts: Bones=%d, Vertices=%d, Faces=%d, Materials=%d"),
-        MeshLOD0.Bones.Num(), MeshLOD0.Vertices.Num(), MeshLOD0.Faces.Num(), MeshLOD0.Materials.Num());
+        MeshLOD0.Bones.Num(), MeshLOD0.NumVertices(), MeshLOD0.NumFaces(), MeshLOD0.Materials.Num());
 
-    // Create packages/assets
-    const FString BasePath = InParent->GetOutermost()->GetName();
+    // Try to add successive LODs: LOD1, LOD2, ... until parse returns no faces
+    // Cap by authored LOD count to avoid generating extra slots
+    int32 AuthoredLODCount = FNiflibBridge::GetAuthoredLODCount(Scene);
+    // LOD0 is already extracted; start at 1 and stop before AuthoredLODCount
+    const int32 MaxRequestedLOD = FMath::Max(1, AuthoredLODCount - 1);
+
+    for (int32 LodIdx = 1; LodIdx <= MaxRequestedLOD; ++LodIdx)
+    {
+        FNifMeshStreams MeshLodN;
+        MeshLodN.MaxInfluences = MaxInfluences;
+        FNifAnimationData AnimN;
+        if (!FNiflibBridge::ExtractLODStreams(Scene, LodIdx, MeshLodN, AnimN))
+        {
+            UE_LOG(LogTemp, Log, TEXT("[NIF] LOD%d parse returned no geometry; stopping."), LodIdx);
+            break;
+        }
+
+        if (MeshLodN.NumFaces() == 0 || MeshLodN.NumVertices() == 0)
+        {
+            UE_LOG(LogTemp, Log, TEXT("[NIF] LOD%d empty; stopping."), LodIdx);
+            break;
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF] Raw LOD%d counts: Bones=%d, Vertices=%d, Faces=%d, Materials=%d"),
+            LodIdx, MeshLodN.Bones.Num(), MeshLodN.NumVertices(), MeshLodN.NumFaces(), MeshLodN.Materials.Num());
+
+        OutLODs.Add(MoveTemp(MeshLodN));
+    }
+
+    return true;
+}
+
+bool UNifSkeletalMeshFactory::LoadImportLODs(const FString& Filename, int32 MaxInfluences, float AnimSampleRate, TArray<FNifMeshStreams>& OutLODs, TArray<FNifAnimationData>& OutAnims)
+{
+    OutAnims.Reset();
+
+    const uint64 CacheKey = FNiflibBridge::GetMeshCacheKey(Filename, MaxInfluences, AnimSampleRate);
+    if (FNiflibBridge::LoadCachedLODs(CacheKey, OutLODs, OutAnims))
+    {
+        return true;
+    }
+
+    // Read + decode the file once; every LOD is extracted from this scene exactly once, so it streams:
+    // geometry the import never selects goes right away, the rest as each LOD is emitted
+    FNifScene* Scene = FNiflibBridge::OpenNifScene(Filename, true);
+    if (!Scene)
+    {
+        UE_LOG(LogTemp, Error, TEXT("[NIF] Failed to read: %s"), *Filename);
+        return false;
+    }
+    FNiflibBridge::ReleaseUnusedLODs(Scene, 0, FNiflibBridge::GetAuthoredLODCount(Scene));
+
+    const bool bExtracted = ExtractImportLODs(Scene, MaxInfluences, OutLODs);
+    if (bExtracted && AnimSampleRate > 0.f)
+    {
+        // Clips bind to the LOD0 skeleton, which is the one the assets are built with
+        FNiflibBridge::ExtractAnimations(Scene, OutLODs[0].Bones, AnimSampleRate, OutAnims);
+    }
+    // Everything needed is extracted; the block graph's teardown happens off the game thread
+    FNiflibBridge::ReleaseNifSceneDeferred(Scene);
+    FNiflibBridge::LogMemoryStage(Filename, TEXT("scene release queued"));
+    if (!bExtracted)
+    {
+        UE_LOG(LogTemp, Error, TEXT("[NIF] Parse failed (LOD0): %s"), *Filename);
+        return false;
+    }
+
+    FNiflibBridge::StoreCachedLODs(CacheKey, OutLODs, OutAnims);
+    return true;
+}
 
+USkeletalMesh* UNifSkeletalMeshFactory::CreateSkeletalMeshFromLODs(const FString& BasePath, const FString& AssetName, TArray<FNifMeshStreams>& LODs)
+{
+    check(IsInGameThread());
+    if (LODs.Num() == 0) return nullptr;
+
+    FNifMeshStreams& MeshLOD0 = LODs[0];
+
+    // Create packages/assets
     FString SkelObjName, MeshObjName;
-    UPackage* SkelPkg = MakeAssetPackage(BasePath, InName.ToString() + TEXT("_Skeleton"), SkelObjName);
-    UPackage* MeshPkg = MakeAssetPackage(BasePath, InName.ToString(), MeshObjName);
+    UPackage* SkelPkg = MakeAssetPackage(BasePath, AssetName + TEXT("_Skeleton"), SkelObjName);
+    UPackage* MeshPkg = MakeAssetPackage(BasePath, AssetName, MeshObjName);
 
     USkeleton* Skeleton = NewObject<USkeleton>(SkelPkg, *SkelObjName, RF_Public | RF_Standalone);
     USkeletalMesh* SkeletalMesh = NewObject<USkeletalMesh>(MeshPkg, *MeshObjName, RF_Public | RF_Standalone);
@@ -342,7 +368,6 @@ UObject* UNifSkeletalMeshFactory::FactoryCreateFile(
     if (!BuildOneLOD(0, MeshLOD0, SkeletalMesh, RefSkeleton, bHasImportNormalsLOD))
     {
         UE_LOG(LogTemp, Error, TEXT("[NIF] Failed building LOD0."));
-        bOutOperationCanceled = true;
         return nullptr;
     }
 
@@ -370,41 +395,24 @@ UObject* UNifSkeletalMeshFactory::FactoryCreateFile(
         }
     }
 
-    // Try to add successive LODs: LOD1, LOD2, ... until parse returns no faces
-    // Cap by authored LOD count to avoid generating extra slots
-    int32 AuthoredLODCount = FNiflibBridge::GetAuthoredLODCount(Filename);
-    // We already built LOD0; start at 1 and stop before AuthoredLODCount
-    const int32 MaxRequestedLOD = FMath::Max(1, AuthoredLODCount - 1);
+    // The LOD model owns its own copy now; only LOD0's bones and materials are read again
+    MeshLOD0.EmptyStreams();
+    FNiflibBridge::LogMemoryStage(AssetName, TEXT("LOD0 built"));
 
-    for (int32 LodIdx = 1; LodIdx <= MaxRequestedLOD; ++LodIdx)
+    // Remaining LODs
+    for (int32 LodIdx = 1; LodIdx < LODs.Num(); ++LodIdx)
     {
-        FNifMeshData MeshLodN;
-        FNifAnimationData AnimN;
-        if (!FNiflibBridge::ParseNifFileWithLOD(Filename, LodIdx, MeshLodN, AnimN))
-        {
-            UE_LOG(LogTemp, Log, TEXT("[NIF] LOD%d parse returned no geometry; stopping."), LodIdx);
-            break;
-        }
-
-        if (MeshLodN.Faces.Num() == 0 || MeshLodN.Vertices.Num() == 0)
-        {
-            UE_LOG(LogTemp, Log, TEXT("[NIF] LOD%d empty; stopping."), LodIdx);
-            break;
-        }
-
-        UE_LOG(LogTemp, Log, TEXT("[NIF] Raw LOD%d counts: Bones=%d, Vertices=%d, Faces=%d, Materials=%d"),
-            LodIdx, MeshLodN.Bones.Num(), MeshLodN.Vertices.Num(), MeshLodN.Faces.Num(), MeshLodN.Materials.Num());
-
         bool bHasImportNormalsThisLOD = false;
         SkeletalMesh->AddLODInfo();
-        if (!BuildOneLOD(LodIdx, MeshLodN, SkeletalMesh, RefSkeleton, bHasImportNormalsThisLOD))
+        if (!BuildOneLOD(LodIdx, LODs[LodIdx], SkeletalMesh, RefSkeleton, bHasImportNormalsThisLOD))
         {
             UE_LOG(LogTemp, Warning, TEXT("[NIF] Failed building LOD%d; stopping further LODs."), LodIdx);
             break;
         }
+        LODs[LodIdx].EmptyStreams();
+        FNiflibBridge::LogMemoryStage(AssetName, *FString::Printf(TEXT("LOD%d built"), LodIdx));
     }
 
-
     SkeletalMesh->InvalidateDeriveDataCacheGUID();
 
     // Finalize
@@ -427,3 +435,100 @@ UObject* UNifSkeletalMeshFactory::FactoryCreateFile(
 
     return SkeletalMesh;
 }
+
+TArray<UAnimSequence*> UNifSkeletalMeshFactory::CreateAnimSequences(USkeleton* Skeleton, USkeletalMesh* PreviewMesh, const FString& BasePath, const FString& AssetName, const TArray<FNifAnimationData>& Anims)
+{
+    check(IsInGameThread());
+    TArray<UAnimSequence*> Created;
+    if (!Skeleton) return Created;
+
+    const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+
+    for (const FNifAnimationData& Anim : Anims)
+    {
+        if (Anim.NumFrames <= 0 || Anim.Tracks.Num() == 0) continue;
+
+        const FString ClipName = Anim.Name.IsEmpty() ? FString::Printf(TEXT("Anim%d"), Created.Num()) : Anim.Name;
+        FString SeqObjName;
+        UPackage* SeqPkg = MakeAssetPackage(BasePath, AssetName + TEXT("_") + ClipName, SeqObjName);
+
+        UAnimSequence* Sequence = NewObject<UAnimSequence>(SeqPkg, *SeqObjName, RF_Public | RF_Standalone);
+        Sequence->SetSkeleton(Skeleton);
+        if (PreviewMesh)
+        {
+            Sequence->SetPreviewMesh(PreviewMesh);
+        }
+
+        IAnimationDataController& Controller = Sequence->GetController();
+        Controller.OpenBracket(FText::FromString(TEXT("Import NIF animation")), false);
+        Controller.InitializeModel();
+        Controller.SetFrameRate(FFrameRate(FMath::RoundToInt(Anim.SampleRate), 1), false);
+        Controller.SetNumberOfFrames(FFrameNumber(FMath::Max(1, Anim.NumFrames - 1)), false);
+
+        int32 NumBoneTracks = 0;
+        for (const FNifKeyframeTrack& Track : Anim.Tracks)
+        {
+            // BoneIndex refers to the bone list the clip was extracted against, which is this skeleton's order;
+            // tracks on nodes that did not make it into the skeleton (cameras, props) have nothing to drive
+            FName BoneName = NAME_None;
+            if (RefSkeleton.IsValidIndex(Track.BoneIndex))
+                BoneName = RefSkeleton.GetBoneName(Track.BoneIndex);
+            else if (RefSkeleton.FindBoneIndex(FName(*Track.BoneName)) != INDEX_NONE)
+                BoneName = FName(*Track.BoneName);
+            if (BoneName.IsNone()) continue;
+            if (Track.Translations.Num() != Anim.NumFrames) continue;
+
+            Controller.AddBoneCurve(BoneName, false);
+            Controller.SetBoneTrackKeys(BoneName, Track.Translations, Track.Rotations, Track.Scales, false);
+            ++NumBoneTracks;
+        }
+
+        Controller.NotifyPopulated();
+        Controller.CloseBracket(false);
+
+        FAssetRegistryModule::AssetCreated(Sequence);
+        SeqPkg->MarkPackageDirty();
+        Created.Add(Sequence);
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF] Imported AnimSequence %s (Frames=%d @ %.0f Hz, BoneTracks=%d/%d)"),
+            *SeqObjName, Anim.NumFrames, Anim.SampleRate, NumBoneTracks, Anim.Tracks.Num());
+    }
+    return Created;
+}
+
+UObject* UNifSkeletalMeshFactory::FactoryCreateFile(
+    UClass* InClass,
+    UObject* InParent,
+    FName InName,
+    EObjectFlags Flags,
+    const FString& Filename,
+    const TCHAR* Parms,
+    FFeedbackContext* Warn,
+    bool& bOutOperationCanceled)
+{
+    UE_LOG(LogTemp, Log, TEXT("[NIF] Importing %s"), *Filename);
+
+    const int32 MaxInfluences = FMath::Clamp(MaxBoneInfluences, 1, (int32)MAX_TOTAL_INFLUENCES);
+
+    const float AnimSampleRate = bImportAnimations ? FMath::Max(1.0f, AnimationSampleRate) : 0.0f;
+
+    TArray<FNifMeshStreams> LODs;
+    TArray<FNifAnimationData> Anims;
+    if (!LoadImportLODs(Filename, MaxInfluences, AnimSampleRate, LODs, Anims))
+    {
+        bOutOperationCanceled = true;
+        return nullptr;
+    }
+
+    // Create packages/assets
+    const FString BasePath = InParent->GetOutermost()->GetName();
+    USkeletalMesh* SkeletalMesh = CreateSkeletalMeshFromLODs(BasePath, InName.ToString(), LODs);
+    if (!SkeletalMesh)
+    {
+        bOutOperationCanceled = true;
+        return nullptr;
+    }
+
+    CreateAnimSequences(SkeletalMesh->GetSkeleton(), SkeletalMesh, BasePath, InName.ToString(), Anims);
+    return SkeletalMesh;
+}
@@ -0,0 +1,52 @@
+// NifAnimationFactory.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Factories/Factory.h"
+#include "NiflibBridge.h"
+#include "NifAnimationFactory.generated.h"
+
+class USkeleton;
+
+/**
+ * Factory for importing .kf animation files and .kfm action graphs as AnimSequences on an existing Skeleton
+ */
+UCLASS()
+class UNifAnimationFactory : public UFactory
+{
+    GENERATED_BODY()
+
+public:
+    UNifAnimationFactory();
+
+    // UFactory interface
+    virtual bool FactoryCanImport(const FString& Filename) override;
+
+    virtual UObject* FactoryCreateFile(
+        UClass* InClass,
+        UObject* InParent,
+        FName InName,
+        EObjectFlags Flags,
+        const FString& Filename,
+        const TCHAR* Parms,
+        FFeedbackContext* Warn,
+        bool& bOutOperationCanceled
+    ) override;
+
+    /** Reference skeleton of Skeleton as bridge bones (same order, local ref pose), for binding tracks by name. */
+    static void SkeletonToNifBones(const USkeleton* Skeleton, TArray<FNifBone>& OutBones);
+
+    /** Resample the clips of every file against Bones, one file at a time. OutClips[i] belongs to Files[i]. */
+    static void ExtractClips(const TArray<FString>& Files, const TArray<FNifBone>& Bones, float SampleRate, TArray<TArray<FNifAnimationData>>& OutClips);
+
+    /** Skeleton named <ModelHint>_Skeleton if there is one, otherwise the one sharing the most bone names (canonicalized) with Clips. */
+    static USkeleton* FindSkeletonForClips(const TArray<FNifAnimationData>& Clips, const FString& ModelHint);
+
+    /** Skeleton the clips are bound to. If unset, it is looked up from the .kfm's model name or by bone-name overlap. */
+    UPROPERTY(EditAnywhere, Category = "NIF Import")
+    TObjectPtr<USkeleton> TargetSkeleton;
+
+    /** Frame rate the animation keys are resampled to. */
+    UPROPERTY(EditAnywhere, Category = "NIF Import", meta = (ClampMin = "1"))
+    float AnimationSampleRate = 30.0f;
+};
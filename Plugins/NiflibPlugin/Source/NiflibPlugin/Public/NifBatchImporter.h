@@ -0,0 +1,61 @@
+// NifBatchImporter.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NiflibBridge.h"
+
+class USkeleton;
+
+/** Options for a batch import run. */
+struct FNifBatchImportOptions
+{
+	/** Content path the assets are created under, e.g. /Game/Imported. Source sub-folders are mirrored below it. */
+	FString DestPath = TEXT("/Game/NifImport");
+
+	/** Bone influences kept per vertex. Clamped to MAX_TOTAL_INFLUENCES. */
+	int32 MaxBoneInfluences = NifDefaultMaxInfluences;
+
+	/** Files parsed per task-pool wave; the game thread builds one wave while the next one parses. */
+	int32 ChunkSize = 32;
+
+	/** Also create AnimSequences from each file's animation clips, resampled at AnimationSampleRate. */
+	bool bImportAnimations = true;
+	float AnimationSampleRate = 30.0f;
+
+	/** Save each created package to disk once it is built. */
+	bool bSavePackages = false;
+};
+
+/** Per-stage timings of a batch import. Read/Extract are pool time (cache hits summed across workers); Build/Save are game-thread time. */
+struct FNifBatchImportStats
+{
+	int32 NumFiles = 0;
+	int32 NumImported = 0;
+	int32 NumFailed = 0;
+
+	double ReadSeconds = 0.0;
+	double ExtractSeconds = 0.0;
+	double BuildSeconds = 0.0;
+	double SaveSeconds = 0.0;
+	double WallSeconds = 0.0;
+};
+
+/**
+ * Imports many .nif files as Skeletal Meshes. Reading and extraction run on the task pool, overlapping the
+ * USkeleton/USkeletalMesh creation on the game thread. Mesh cache hits load in parallel; cache misses go through
+ * niflib one file at a time (see FNifReader::GetNiflibLock).
+ */
+namespace FNifBatchImporter
+{
+	/** Collect the files matching Wildcard (.nif by default) under Folder. */
+	TArray<FString> GatherFiles(const FString& Folder, bool bRecursive, const TCHAR* Wildcard = TEXT("*.nif"));
+
+	/** Import an explicit file list. SourceRoot (optional) is stripped from each path to build the destination sub-folder. Game thread only. */
+	FNifBatchImportStats ImportFiles(const TArray<FString>& Files, const FNifBatchImportOptions& Options, const FString& SourceRoot = FString());
+
+	/** Import every .nif under Folder. Game thread only. */
+	FNifBatchImportStats ImportFolder(const FString& Folder, bool bRecursive, const FNifBatchImportOptions& Options);
+
+	/** Import .kf files as AnimSequences on Skeleton. Only one chunk of resampled clips is held at a time. Game thread only. */
+	FNifBatchImportStats ImportAnimationFiles(const TArray<FString>& Files, USkeleton* Skeleton, const FNifBatchImportOptions& Options, const FString& SourceRoot = FString());
+}
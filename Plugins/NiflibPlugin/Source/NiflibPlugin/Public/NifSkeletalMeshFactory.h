@@ -3,8 +3,12 @@
 
 #include "CoreMinimal.h"
 #include "Factories/Factory.h"
+#include "NiflibBridge.h"
 #include "NifSkeletalMeshFactory.generated.h"
 
+class UAnimSequence;
+class USkeleton;
+
 /**
  * Factory for importing .nif files as Skeletal Meshes
  */
@@ -29,4 +33,34 @@ public:
         FFeedbackContext* Warn,
         bool& bOutOperationCanceled
     ) override;
+
+    /** Extract LOD0 and every further authored LOD from an opened scene. Touches no UObjects, so it may run off the game thread. */
+    static bool ExtractImportLODs(const FNifScene* Scene, int32 MaxInfluences, TArray<FNifMeshStreams>& OutLODs);
+
+    /**
+     * Cached front end for ExtractImportLODs: reuse the converted LODs for unchanged files, otherwise open, extract and store.
+     * AnimSampleRate > 0 also resamples the file's animation clips into OutAnims.
+     */
+    static bool LoadImportLODs(const FString& Filename, int32 MaxInfluences, float AnimSampleRate, TArray<FNifMeshStreams>& OutLODs, TArray<FNifAnimationData>& OutAnims);
+
+    /**
+     * Create the Skeleton + SkeletalMesh assets under BasePath from extracted LODs. Game thread only.
+     * Each LOD's streams are emptied once its LOD model is built (bones and materials stay).
+     */
+    static USkeletalMesh* CreateSkeletalMeshFromLODs(const FString& BasePath, const FString& AssetName, TArray<FNifMeshStreams>& LODs);
+
+    /** Create one UAnimSequence per clip under BasePath, bound to Skeleton by bone name. PreviewMesh is optional. Game thread only. */
+    static TArray<UAnimSequence*> CreateAnimSequences(USkeleton* Skeleton, USkeletalMesh* PreviewMesh, const FString& BasePath, const FString& AssetName, const TArray<FNifAnimationData>& Anims);
+
+    /** Bone influences kept per vertex (strongest first, renormalized). Clamped to MAX_TOTAL_INFLUENCES. */
+    UPROPERTY(EditAnywhere, Category = "NIF Import", meta = (ClampMin = "1"))
+    int32 MaxBoneInfluences = NifDefaultMaxInfluences;
+
+    /** Create AnimSequences from the file's NiControllerSequences (or legacy keyframe controllers). */
+    UPROPERTY(EditAnywhere, Category = "NIF Import")
+    bool bImportAnimations = true;
+
+    /** Frame rate the animation keys are resampled to. */
+    UPROPERTY(EditAnywhere, Category = "NIF Import", meta = (ClampMin = "1", EditCondition = "bImportAnimations"))
+    float AnimationSampleRate = 30.0f;
 };
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "NifCore.h"
+#include <cmath>
+#include <vector>
+
+namespace NifCore
+{
+    namespace
+    {
+        // x - x is 0 for finite x and NaN for NaN/Inf
+        static inline float SanitizeFinite(float V)
+        {
+            return (V - V == 0.0f) ? V : 0.0f;
+        }
+
+        // Keep one vertex's K influence slots sorted strongest-first; when full, the weakest falls off
+        static inline void InsertInfluence(int32_t* Bones, float* Weights, int32_t K, int32_t Bone, float Weight)
+        {
+            int32_t Slot = K;
+            for (int32_t k = 0; k < K; ++k)
+            {
+                if (Bones[k] == Bone) { Weight += Weights[k]; Slot = k; break; } // same target bone via two source bones
+                if (Bones[k] == NoBone) { Slot = k; break; }
+            }
+            if (Slot == K)
+            {
+                if (Weight <= Weights[K - 1]) return;
+                Slot = K - 1;
+            }
+            while (Slot > 0 && Weights[Slot - 1] < Weight)
+            {
+                Bones[Slot] = Bones[Slot - 1];
+                Weights[Slot] = Weights[Slot - 1];
+                --Slot;
+            }
+            Bones[Slot] = Bone;
+            Weights[Slot] = Weight;
+        }
+    }
+
+    FStreamTransform FStreamTransform::FromWorldMatrix(const float World[4][4])
+    {
+        FStreamTransform Out;
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                Out.Position[r][c] = World[r][c];
+            }
+        }
+
+        // Rotation only: normalize the basis rows, drop translation
+        for (int r = 0; r < 3; ++r)
+        {
+            const float Len = std::sqrt(World[r][0] * World[r][0] + World[r][1] * World[r][1] + World[r][2] * World[r][2]);
+            const float Inv = Len > 1e-8f ? 1.0f / Len : 0.0f;
+            for (int c = 0; c < 3; ++c)
+            {
+                Out.Direction[r][c] = World[r][c] * Inv;
+            }
+        }
+
+        const double Det =
+            (double)World[0][0] * ((double)World[1][1] * World[2][2] - (double)World[1][2] * World[2][1]) -
+            (double)World[0][1] * ((double)World[1][0] * World[2][2] - (double)World[1][2] * World[2][0]) +
+            (double)World[0][2] * ((double)World[1][0] * World[2][1] - (double)World[1][1] * World[2][0]);
+        Out.bFlipWinding = Det >= 0.0;
+        return Out;
+    }
+
+    void TransformPositions(const FStreamTransform& Xf, const float* InXYZ, int32_t Num, float* OutXYZ)
+    {
+        const float (&M)[4][4] = Xf.Position;
+        for (int32_t i = 0; i < Num; ++i)
+        {
+            const float X = SanitizeFinite(InXYZ[i * 3 + 0]);
+            const float Y = SanitizeFinite(InXYZ[i * 3 + 1]);
+            const float Z = SanitizeFinite(InXYZ[i * 3 + 2]);
+            OutXYZ[i * 3 + 0] = X * M[0][0] + Y * M[1][0] + Z * M[2][0] + M[3][0];
+            OutXYZ[i * 3 + 1] = X * M[0][1] + Y * M[1][1] + Z * M[2][1] + M[3][1];
+            OutXYZ[i * 3 + 2] = X * M[0][2] + Y * M[1][2] + Z * M[2][2] + M[3][2];
+        }
+    }
+
+    void TransformDirections(const FStreamTransform& Xf, const float* InXYZ, int32_t Num, float* OutXYZ)
+    {
+        const float (&M)[4][4] = Xf.Direction;
+        for (int32_t i = 0; i < Num; ++i)
+        {
+            const float X = SanitizeFinite(InXYZ[i * 3 + 0]);
+            const float Y = SanitizeFinite(InXYZ[i * 3 + 1]);
+            const float Z = SanitizeFinite(InXYZ[i * 3 + 2]);
+            const float DX = X * M[0][0] + Y * M[1][0] + Z * M[2][0];
+            const float DY = X * M[0][1] + Y * M[1][1] + Z * M[2][1];
+            const float DZ = X * M[0][2] + Y * M[1][2] + Z * M[2][2];
+
+            // Same threshold as UE's GetSafeNormal (UE_SMALL_NUMBER)
+            const float LengthSq = DX * DX + DY * DY + DZ * DZ;
+            const float Scale = LengthSq > 1e-8f ? 1.0f / std::sqrt(LengthSq) : 0.0f;
+            OutXYZ[i * 3 + 0] = DX * Scale;
+            OutXYZ[i * 3 + 1] = DY * Scale;
+            OutXYZ[i * 3 + 2] = DZ * Scale;
+        }
+    }
+
+    void ConvertTriangles(bool bFlipWinding, const uint16_t* InTris, int32_t NumTris, uint32_t BaseVertex, uint32_t* Out)
+    {
+        const int32_t Second = bFlipWinding ? 2 : 1;
+        const int32_t Third = bFlipWinding ? 1 : 2;
+        for (int32_t t = 0; t < NumTris; ++t)
+        {
+            const uint16_t* Tri = InTris + t * 3;
+            uint32_t* Dst = Out + t * 3;
+            Dst[0] = BaseVertex + Tri[0];
+            Dst[1] = BaseVertex + Tri[Second];
+            Dst[2] = BaseVertex + Tri[Third];
+        }
+    }
+
+    int32_t CountStripTriangles(const uint16_t* Strip, int32_t Len)
+    {
+        // Branch-free sum over the sliding window, so the compiler can vectorize it
+        int32_t Count = 0;
+        for (int32_t i = 2; i < Len; ++i)
+        {
+            const uint16_t A = Strip[i - 2], B = Strip[i - 1], C = Strip[i];
+            Count += (int32_t)((A != B) & (B != C) & (A != C));
+        }
+        return Count;
+    }
+
+    int32_t ConvertStrip(bool bFlipWinding, const uint16_t* Strip, int32_t Len, uint32_t BaseVertex, uint32_t* Out)
+    {
+        // Strip triangle i is (s[i-2], s[i-1], s[i]) with every other one reversed (counting degenerates, as
+        // niflib does); the flip reverses all of them once more. Out is sized exactly, so degenerates
+        // are skipped rather than written and overwritten.
+        const uint32_t FlipBit = bFlipWinding ? 1u : 0u;
+        uint32_t* Dst = Out;
+        for (int32_t i = 2; i < Len; ++i)
+        {
+            const uint32_t A = Strip[i - 2], B = Strip[i - 1], C = Strip[i];
+            if ((A == B) | (B == C) | (A == C)) continue;
+
+            const bool bSwap = (((uint32_t)i & 1u) ^ FlipBit) != 0;
+            Dst[0] = BaseVertex + A;
+            Dst[1] = BaseVertex + (bSwap ? C : B);
+            Dst[2] = BaseVertex + (bSwap ? B : C);
+            Dst += 3;
+        }
+        return (int32_t)(Dst - Out) / 3;
+    }
+
+    FSkinPackStats PackSkinInfluences(const uint32_t* Offsets, const uint16_t* EntryBones, const float* EntryWeights, int32_t NumVerts,
+        const int32_t* BoneMap, int32_t NumMapped, int32_t NumBones, int32_t K, int32_t* Bones, float* Weights)
+    {
+        FSkinPackStats Stats;
+        std::vector<bool> BonesUsed((size_t)(NumBones > 0 ? NumBones : 0), false);
+        for (int32_t v = 0; v < NumVerts; ++v)
+        {
+            for (uint32_t e = Offsets[v]; e < Offsets[v + 1]; ++e)
+            {
+                const int32_t Bone = (EntryBones[e] < (uint32_t)NumMapped) ? BoneMap[EntryBones[e]] : NoBone;
+                if (Bone == NoBone || !(EntryWeights[e] > 0.0f)) continue;
+
+                InsertInfluence(Bones + v * K, Weights + v * K, K, Bone, EntryWeights[e]);
+                ++Stats.CollectedWeights;
+                if ((uint32_t)Bone < (uint32_t)NumBones && !BonesUsed[Bone])
+                {
+                    BonesUsed[Bone] = true;
+                    ++Stats.BonesUsed;
+                }
+            }
+            Stats.ZeroInfluenceVerts += (Bones[v * K] == NoBone) ? 1 : 0;
+        }
+        return Stats;
+    }
+
+    int32_t NormalizeInfluences(int32_t* Bones, float* Weights, int32_t NumVerts, int32_t K, int32_t NumBones, int32_t FallbackBone)
+    {
+        int32_t Dropped = 0;
+        for (int32_t v = 0; v < NumVerts; ++v)
+        {
+            int32_t* VB = Bones + v * K;
+            float* VW = Weights + v * K;
+
+            // Compact the valid entries to the front (order kept); an invalid one is written and then overwritten
+            int32_t Kept = 0;
+            float Sum = 0.0f;
+            for (int32_t k = 0; k < K; ++k)
+            {
+                const int32_t B = VB[k];
+                const float W = VW[k];
+                if (B == NoBone) continue;
+
+                const bool bValid = (uint32_t)B < (uint32_t)NumBones && std::isfinite(W) && W > 0.0f;
+                VB[Kept] = B;
+                VW[Kept] = W;
+                Kept += bValid ? 1 : 0;
+                Sum += bValid ? W : 0.0f;
+                Dropped += bValid ? 0 : 1;
+            }
+            for (int32_t k = Kept; k < K; ++k)
+            {
+                VB[k] = NoBone;
+                VW[k] = 0.0f;
+            }
+
+            // Strongest-first; rows from PackSkinInfluences are already sorted, so this is one compare per slot
+            for (int32_t i = 1; i < Kept; ++i)
+            {
+                const int32_t B = VB[i];
+                const float W = VW[i];
+                int32_t j = i;
+                for (; j > 0 && VW[j - 1] < W; --j)
+                {
+                    VB[j] = VB[j - 1];
+                    VW[j] = VW[j - 1];
+                }
+                VB[j] = B;
+                VW[j] = W;
+            }
+
+            if (Sum > 0.0f)
+            {
+                const float InvSum = 1.0f / Sum;
+                for (int32_t k = 0; k < Kept; ++k)
+                {
+                    VW[k] *= InvSum;
+                }
+            }
+            else
+            {
+                VB[0] = FallbackBone;
+                VW[0] = 1.0f;
+            }
+        }
+        return Dropped;
+    }
+
+    int32_t CountInfluences(const int32_t* Bones, int32_t NumVerts, int32_t K, int32_t NumBones)
+    {
+        int32_t Count = 0;
+        for (int32_t s = 0; s < NumVerts * K; ++s)
+        {
+            Count += ((uint32_t)Bones[s] < (uint32_t)NumBones) ? 1 : 0;
+        }
+        return Count;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Engine-agnostic half of the NIF conversion, part one: the per-geometry stream, face and skin kernels, in plain C++
+ * with no Unreal or niflib types. The scene layer on top (NifCoreScene.h) works on niflib objects. NiflibRuntime
+ * compiles both into the module (FNifVertexKernels and the bridge call them); Tools/NifCore builds them with CMake
+ * for the command-line converter and benchmarks.
+ */
+namespace NifCore
+{
+	static constexpr int32_t NoBone = -1;
+
+	/**
+	 * A geometry's stream transform: 4x4 row-vector matrices (translation in row 3) for positions and for
+	 * directions (rotation only), and the triangle winding that results from both.
+	 */
+	struct FStreamTransform
+	{
+		float Position[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+		float Direction[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+		bool bFlipWinding = true;                       // NIF is right-handed; a mirrored world matrix cancels the flip
+
+		/** Build from a row-vector world matrix; Direction is its normalized rotation, bFlipWinding = det >= 0. */
+		static FStreamTransform FromWorldMatrix(const float World[4][4]);
+	};
+
+	/** Out[i] = In[i] * Position, xyz packed in and out; non-finite input components read as 0. */
+	void TransformPositions(const FStreamTransform& Xf, const float* InXYZ, int32_t Num, float* OutXYZ);
+
+	/** Out[i] = normalize(In[i] * Direction); degenerate directions come out as zero. */
+	void TransformDirections(const FStreamTransform& Xf, const float* InXYZ, int32_t Num, float* OutXYZ);
+
+	/** Widen NumTris uint16 triangles (v1 v2 v3) to uint32 + BaseVertex, swapping v2/v3 when bFlipWinding. Out holds NumTris * 3. */
+	void ConvertTriangles(bool bFlipWinding, const uint16_t* InTris, int32_t NumTris, uint32_t BaseVertex, uint32_t* Out);
+
+	/** Triangles a strip of Len indices yields once degenerates (any two corners equal) are dropped. */
+	int32_t CountStripTriangles(const uint16_t* Strip, int32_t Len);
+
+	/**
+	 * Expand one triangle strip straight into a list: alternating winding, degenerates dropped, bFlipWinding
+	 * applied and BaseVertex added. Out must hold CountStripTriangles() * 3 entries; returns the triangles written.
+	 */
+	int32_t ConvertStrip(bool bFlipWinding, const uint16_t* Strip, int32_t Len, uint32_t BaseVertex, uint32_t* Out);
+
+	/** Skin counters PackSkinInfluences reports for one geometry. */
+	struct FSkinPackStats
+	{
+		int32_t CollectedWeights = 0;                   // entries that landed in a row (before the K cut)
+		int32_t ZeroInfluenceVerts = 0;                 // rows left empty (the fallback bone fills them later)
+		int32_t BonesUsed = 0;                          // distinct target bones referenced
+	};
+
+	/**
+	 * Fill NumVerts packed rows of K slots (strongest first, same target bone merged, weakest falling off) from a
+	 * vertex-major weight table: entries Offsets[v] .. Offsets[v+1]-1 of EntryBones / EntryWeights belong to vertex v.
+	 * EntryBones index BoneMap (NumMapped entries, NoBone = unmapped); mapped bones are below NumBones. Rows must
+	 * start empty (bone NoBone, weight 0). Non-positive weights are skipped.
+	 */
+	FSkinPackStats PackSkinInfluences(const uint32_t* Offsets, const uint16_t* EntryBones, const float* EntryWeights, int32_t NumVerts,
+		const int32_t* BoneMap, int32_t NumMapped, int32_t NumBones, int32_t K, int32_t* Bones, float* Weights);
+
+	/**
+	 * Clean up NumVerts packed influence rows of K slots in place: drop entries with a bone outside [0, NumBones)
+	 * or a non-finite / non-positive weight, sort strongest-first, renormalize, and give rows left empty a single
+	 * FallbackBone influence. Returns the entries dropped.
+	 */
+	int32_t NormalizeInfluences(int32_t* Bones, float* Weights, int32_t NumVerts, int32_t K, int32_t NumBones, int32_t FallbackBone);
+
+	/** Used slots (bone in [0, NumBones)) across NumVerts rows of K; sizes a flat influence list exactly. */
+	int32_t CountInfluences(const int32_t* Bones, int32_t NumVerts, int32_t K, int32_t NumBones);
+}
@@ -0,0 +1,357 @@
+#include "NifCoreScene.h"
+
+#include <obj/NiAVObject.h>
+#include <obj/NiNode.h>
+#include <obj/NiLODNode.h>
+#include <obj/NiGeometry.h>
+#include <obj/NiGeometryData.h>
+#include <obj/NiTriShape.h>
+#include <obj/NiTriStrips.h>
+#include <obj/NiProperty.h>
+#include <obj/NiMaterialProperty.h>
+#include <obj/NiTexturingProperty.h>
+#include <obj/NiSourceTexture.h>
+#include <obj/NiStencilProperty.h>
+#include <obj/NiSkinInstance.h>
+#include <obj/NiSkinData.h>
+#include <gen/enums.h>
+
+#include <algorithm>
+#include <utility>
+
+using namespace Niflib;
+
+namespace NifCore
+{
+    namespace
+    {
+        // Borrowed DynamicCast through the index's type test; no Ref is made, so refcounts are not touched
+        template <class T>
+        static inline T* As(const FSceneIndex& Index, NiObject* Obj)
+        {
+            return (Obj && Index.IsDerived(Obj->GetType(), T::TYPE)) ? static_cast<T*>(Obj) : nullptr;
+        }
+
+        static std::string ToLowerAscii(std::string S)
+        {
+            for (char& Ch : S)
+            {
+                if (Ch >= 'A' && Ch <= 'Z') Ch = (char)(Ch - 'A' + 'a');
+            }
+            return S;
+        }
+
+        static bool EqualsIgnoreCase(const std::string& A, const std::string& B)
+        {
+            return A.size() == B.size() && ToLowerAscii(A) == ToLowerAscii(B);
+        }
+
+        static int32_t InternMaterialName(const FSceneIndex& Index, const NiGeometry* Geo, FNameTable& Names)
+        {
+            for (const NiPropertyRef& p : Geo->GetPropertiesView())
+            {
+                if (NiMaterialProperty* mp = As<NiMaterialProperty>(Index, p))
+                {
+                    const std::string& Name = mp->GetName();
+                    if (!Name.empty())
+                    {
+                        return Names.Intern(Name);
+                    }
+                }
+            }
+            return Names.Intern("NifMat");
+        }
+
+        // Shadow-like geometry rule: by name or stencil property
+        static bool IsShadowLike(const FSceneIndex& Index, NiAVObject* Obj, const std::string& LowerName)
+        {
+            if (LowerName.find("shadow") != std::string::npos)
+            {
+                return true;
+            }
+            if (NiGeometry* Geo = As<NiGeometry>(Index, Obj))
+            {
+                for (const NiPropertyRef& p : Geo->GetPropertiesView())
+                {
+                    if (As<NiStencilProperty>(Index, p)) return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    bool NiflibIsDerived(const Type& InType, const Type& Base)
+    {
+        return InType.IsDerivedType(Base);
+    }
+
+    std::string CanonName(const std::string& Name)
+    {
+        return Name.compare(0, 5, "Game_") == 0 ? Name.substr(5) : Name;
+    }
+
+    int32_t FNameTable::Intern(const std::string& Name)
+    {
+        const auto Found = Ids.find(Name);
+        if (Found != Ids.end()) return Found->second;
+
+        const int32_t Id = (int32_t)Names.size();
+        Names.push_back(Name);
+        KeyIds.push_back(Id);
+        CanonIds.push_back(Id);
+        Ids.emplace(Name, Id);
+
+        // Lower-cased forms are their own key and canon (CanonName's prefix is case-sensitive), so this recurses once
+        const std::string Key = ToLowerAscii(Name);
+        const std::string Canon = ToLowerAscii(CanonName(Name));
+        if (Key != Name)
+        {
+            const int32_t KeyId = Intern(Key);
+            KeyIds[Id] = KeyId;
+        }
+        if (Canon != Key)
+        {
+            const int32_t CanonId = Intern(Canon);
+            CanonIds[Id] = CanonId;
+        }
+        else
+        {
+            CanonIds[Id] = KeyIds[Id];
+        }
+        return Id;
+    }
+
+    int32_t FNameTable::Find(const std::string& Name) const
+    {
+        const auto Found = Ids.find(Name);
+        return Found != Ids.end() ? Found->second : NoIndex;
+    }
+
+    int32_t FSceneIndex::Find(const NiAVObject* Obj) const
+    {
+        const auto Found = NodeIndex.find(Obj);
+        return Found != NodeIndex.end() ? Found->second : NoIndex;
+    }
+
+    int32_t FSceneIndex::NumUses(const NiObject* Data) const
+    {
+        const auto Found = DataUses.find(Data);
+        return Found != DataUses.end() ? Found->second : 0;
+    }
+
+    void BuildSceneIndex(const std::vector<NiObjectRef>& Blocks, const std::vector<std::string>& HeaderStrings,
+        FIsDerivedFn IsDerived, FSceneIndex& Out)
+    {
+        Out = FSceneIndex();
+        Out.IsDerived = IsDerived ? IsDerived : &NiflibIsDerived;
+        Out.Names.Names.reserve(HeaderStrings.size());
+        Out.Names.Ids.reserve(HeaderStrings.size());
+        for (const std::string& Str : HeaderStrings)
+        {
+            Out.Names.Intern(Str);
+        }
+
+        // The block list holds every object (so the walk can use raw pointers); walks start only at parentless
+        // AV objects. Entries are (object, parent node index), pushed in reverse so pops come out in block / child order.
+        std::vector<std::pair<NiAVObject*, int32_t>> Stack;
+        for (auto It = Blocks.rbegin(); It != Blocks.rend(); ++It)
+        {
+            NiAVObject* AV = As<NiAVObject>(Out, *It);
+            if (AV && !AV->GetParent())
+            {
+                Stack.emplace_back(AV, NoIndex);
+            }
+        }
+
+        while (!Stack.empty())
+        {
+            const std::pair<NiAVObject*, int32_t> Entry = Stack.back();
+            Stack.pop_back();
+            if (Out.NodeIndex.count(Entry.first)) continue;
+
+            const int32_t Idx = (int32_t)Out.Nodes.size();
+            Out.Nodes.emplace_back();
+            Out.NodeIndex.emplace(Entry.first, Idx);
+            {
+                FSceneNode& N = Out.Nodes[Idx];
+                N.Obj = Entry.first;
+                N.Parent = Entry.second;
+                N.Geo = As<NiGeometry>(Out, N.Obj);
+                N.NameId = Out.Names.Intern(N.Obj->GetName());
+                N.MaterialNameId = N.Geo ? InternMaterialName(Out, N.Geo, Out.Names) : NoIndex;
+                N.bTriGeometry = As<NiTriShape>(Out, N.Obj) || As<NiTriStrips>(Out, N.Obj);
+                N.bShadow = IsShadowLike(Out, N.Obj, Out.Names.Names[Out.Names.KeyIds[N.NameId]]);
+                Out.NumGeometries += N.Geo ? 1 : 0;
+            }
+
+            NiNode* AsNode = As<NiNode>(Out, Entry.first);
+            if (!AsNode) continue;
+            Out.Nodes[Idx].bNode = true;
+
+            const std::vector<NiAVObjectRef>& Children = AsNode->GetChildrenView();
+            if (As<NiLODNode>(Out, AsNode))
+            {
+                int32_t ChildNodes = 0;
+                for (const NiAVObjectRef& c : Children)
+                {
+                    if (As<NiNode>(Out, c)) { ++ChildNodes; }
+                }
+                Out.AuthoredLODCount = std::max(Out.AuthoredLODCount, ChildNodes);
+                if (Out.FirstLOD == NoIndex)
+                {
+                    Out.FirstLOD = Idx;
+                }
+            }
+            for (auto It = Children.rbegin(); It != Children.rend(); ++It)
+            {
+                if (*It) Stack.emplace_back(static_cast<NiAVObject*>(*It), Idx);
+            }
+        }
+
+        // Pre-order keeps every subtree contiguous; close the ranges bottom-up
+        for (int32_t i = (int32_t)Out.Nodes.size() - 1; i >= 0; --i)
+        {
+            FSceneNode& N = Out.Nodes[i];
+            N.SubtreeEnd = std::max(N.SubtreeEnd, i + 1);
+            if (N.Parent != NoIndex)
+            {
+                Out.Nodes[N.Parent].SubtreeEnd = std::max(Out.Nodes[N.Parent].SubtreeEnd, N.SubtreeEnd);
+            }
+        }
+
+        if (Out.FirstLOD != NoIndex)
+        {
+            for (int32_t i = Out.FirstLOD + 1; i < Out.Nodes[Out.FirstLOD].SubtreeEnd; i = Out.Nodes[i].SubtreeEnd)
+            {
+                if (Out.Nodes[i].bNode) Out.LODBuckets.push_back(i);
+            }
+        }
+
+        // Skins: bone lists are fetched once and resolved to graph nodes. Data shared between geometry nodes is
+        // counted so streaming scenes only free what a single node owns.
+        for (int32_t i = 0; i < (int32_t)Out.Nodes.size(); ++i)
+        {
+            if (!Out.Nodes[i].Geo) continue;
+            if (NiGeometryDataRef Data = Out.Nodes[i].Geo->GetData())
+            {
+                ++Out.DataUses[Data];
+            }
+            NiSkinInstanceRef Instance = Out.Nodes[i].Geo->GetSkinInstance();
+            if (!Instance) continue;
+            if (NiSkinDataRef SkinData = Instance->GetSkinData())
+            {
+                ++Out.DataUses[SkinData];
+            }
+
+            Out.Nodes[i].Skin = (int32_t)Out.Skins.size();
+            Out.Skins.emplace_back();
+            FSceneSkin& Skin = Out.Skins.back();
+            Skin.Instance = Instance;
+            Skin.SkeletonRoot = Out.Find(Instance->GetSkeletonRoot());
+            Skin.BoneNodes = Instance->GetBonesView();
+            Skin.Bones.resize(Skin.BoneNodes.size());
+            Skin.BoneNameIds.assign(Skin.BoneNodes.size(), NoIndex);
+            for (size_t b = 0; b < Skin.Bones.size(); ++b)
+            {
+                Skin.Bones[b] = Out.Find(Skin.BoneNodes[b]);
+                if (Skin.Bones[b] != NoIndex)
+                {
+                    Skin.BoneNameIds[b] = Out.Nodes[Skin.Bones[b]].NameId;
+                }
+                else if (Skin.BoneNodes[b])
+                {
+                    Skin.BoneNameIds[b] = Out.Names.Intern(Skin.BoneNodes[b]->GetName());
+                }
+            }
+        }
+    }
+
+    int32_t FindNonShadowTriGeometry(const FSceneIndex& Index, int32_t First, int32_t End)
+    {
+        for (int32_t i = First; i < End; ++i)
+        {
+            const FSceneNode& N = Index.Nodes[i];
+            if (N.bTriGeometry && !N.bShadow) return i;
+        }
+        return NoIndex;
+    }
+
+    bool SelectLODGeometries(const FSceneIndex& Index, int32_t RequestedLOD, FLODSelection& Out)
+    {
+        Out = FLODSelection();
+
+        // No NiLODNode: the scene's first usable geometry is the only LOD
+        if (Index.FirstLOD == NoIndex)
+        {
+            const int32_t FirstTri = FindNonShadowTriGeometry(Index, 0, (int32_t)Index.Nodes.size());
+            if (FirstTri == NoIndex) return false;
+            Out.GeoNodes.push_back(FirstTri);
+            return true;
+        }
+
+        if (Index.LODBuckets.empty()) return false;
+
+        const int32_t NumBuckets = (int32_t)Index.LODBuckets.size();
+        Out.Bucket = std::min(std::max(RequestedLOD, 0), NumBuckets - 1);
+        const int32_t Selected = Index.LODBuckets[Out.Bucket];
+        for (int32_t Child = Selected + 1; Child < Index.Nodes[Selected].SubtreeEnd; Child = Index.Nodes[Child].SubtreeEnd)
+        {
+            const int32_t Tri = FindNonShadowTriGeometry(Index, Child, Index.Nodes[Child].SubtreeEnd);
+            if (Tri != NoIndex)
+            {
+                Out.GeoNodes.push_back(Tri);
+            }
+            else
+            {
+                Out.EmptyChildren.push_back(Child);
+            }
+        }
+        return !Out.GeoNodes.empty();
+    }
+
+    std::string GetDiffuseTexturePath(const FSceneIndex& Index, const NiGeometry* Geo)
+    {
+        if (!Geo) return std::string();
+
+        for (const NiPropertyRef& p : Geo->GetPropertiesView())
+        {
+            NiTexturingProperty* TP = As<NiTexturingProperty>(Index, p);
+            if (!TP || !TP->HasTexture(Niflib::BASE_MAP)) continue;
+
+            const TexDesc& Base = TP->GetTexture(Niflib::BASE_MAP);
+            if (Base.source && !Base.source->GetTextureFileName().empty())
+            {
+                return Base.source->GetTextureFileName();
+            }
+        }
+        return std::string();
+    }
+
+    int32_t FMaterialTable::Gather(const FSceneIndex& Index, int32_t NodeIdx, std::string& OutConflictPath)
+    {
+        OutConflictPath.clear();
+        const FSceneNode& Node = Index.Nodes[NodeIdx];
+        const std::string DiffusePath = GetDiffuseTexturePath(Index, Node.Geo);
+
+        const int32_t KeyId = Index.Names.KeyIds[Node.MaterialNameId];
+        const auto Found = SlotByKeyId.find(KeyId);
+        if (Found == SlotByKeyId.end())
+        {
+            const int32_t Slot = (int32_t)Slots.size();
+            Slots.push_back(FMaterialSlot{ Node.MaterialNameId, DiffusePath });
+            SlotByKeyId.emplace(KeyId, Slot);
+            return Slot;
+        }
+
+        FMaterialSlot& Existing = Slots[Found->second];
+        if (Existing.DiffuseTexturePath.empty())
+        {
+            Existing.DiffuseTexturePath = DiffusePath;
+        }
+        else if (!DiffusePath.empty() && !EqualsIgnoreCase(Existing.DiffuseTexturePath, DiffusePath))
+        {
+            OutConflictPath = DiffusePath;
+        }
+        return Found->second;
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "NifCore.h"
+
+#include <niflib.h>
+#include <obj/NiObject.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Niflib
+{
+	class NiAVObject;
+	class NiGeometry;
+	class NiNode;
+	class NiSkinInstance;
+}
+
+/**
+ * Engine-agnostic scene layer over a parsed niflib block list: the scene walk and name table, LOD buckets and LOD
+ * geometry selection, skin bone resolution and material slots. Plain C++ on niflib types; the UE bridge adapts it
+ * to FTransform / FString and logs, NifConvert writes OBJ from it. Build it with the niflib lock held (the bridge's
+ * FNifReader::GetNiflibLock()); the index holds raw pointers the block list keeps alive.
+ */
+namespace NifCore
+{
+	static constexpr int32_t NoIndex = -1;
+
+	/** Subtype test the walk uses: is Type Base or derived from it. The bridge passes its constant-time FNifTypeIndex. */
+	using FIsDerivedFn = bool (*)(const Niflib::Type& Type, const Niflib::Type& Base);
+
+	/** niflib's own walk up Type::base_type; the default where no faster index exists. */
+	bool NiflibIsDerived(const Niflib::Type& Type, const Niflib::Type& Base);
+
+	/** Name with the "Game_" bone prefix (case-sensitive) removed, so prefixed and plain bones match. */
+	std::string CanonName(const std::string& Name);
+
+	/**
+	 * Every distinct name in a file gets an integer id once, with one case fold and one CanonName per unique
+	 * string; bone, material and node mapping then compare ids. Keys are ASCII case-folded.
+	 */
+	struct FNameTable
+	{
+		std::vector<std::string> Names;             // id -> name as authored
+		std::vector<int32_t> KeyIds;                // id -> id of the lower-cased name
+		std::vector<int32_t> CanonIds;              // id -> id of the lower-cased CanonName(name)
+		std::unordered_map<std::string, int32_t> Ids;
+
+		int32_t Intern(const std::string& Name);
+		int32_t Find(const std::string& Name) const;    // NoIndex if never interned
+	};
+
+	/** One NiAVObject of the graph, in pre-order. */
+	struct FSceneNode
+	{
+		Niflib::NiAVObject* Obj = nullptr;
+		Niflib::NiGeometry* Geo = nullptr;          // set for NiGeometry
+		int32_t NameId = NoIndex;
+		int32_t MaterialNameId = NoIndex;           // NiGeometry: first named NiMaterialProperty, else "NifMat"
+		int32_t Parent = NoIndex;
+		int32_t SubtreeEnd = 0;                     // descendants are [this + 1, SubtreeEnd)
+		int32_t Skin = NoIndex;                     // into FSceneIndex::Skins
+		bool bNode = false;                         // NiNode (can have children)
+		bool bTriGeometry = false;                  // NiTriShape or NiTriStrips (what the importers can triangulate)
+		bool bShadow = false;                       // "shadow" in the name or a NiStencilProperty
+	};
+
+	/** A geometry's NiSkinInstance with its bones resolved to graph nodes and names. */
+	struct FSceneSkin
+	{
+		Niflib::NiSkinInstance* Instance = nullptr;
+		int32_t SkeletonRoot = NoIndex;
+		std::vector<Niflib::NiNode*> BoneNodes;     // NiSkinInstance order (= NiSkinData bone order)
+		std::vector<int32_t> Bones;                 // node per BoneNodes entry, NoIndex if not in the graph
+		std::vector<int32_t> BoneNameIds;           // name per BoneNodes entry, NoIndex for null bones
+	};
+
+	/**
+	 * One pre-order walk of the scene graph per file; LOD and geometry selection read from it instead of re-walking
+	 * the graph per query.
+	 */
+	struct FSceneIndex
+	{
+		FIsDerivedFn IsDerived = &NiflibIsDerived;
+		FNameTable Names;
+		std::vector<FSceneNode> Nodes;
+		std::unordered_map<const Niflib::NiAVObject*, int32_t> NodeIndex;
+		std::vector<FSceneSkin> Skins;
+		int32_t NumGeometries = 0;
+		int32_t FirstLOD = NoIndex;                 // first NiLODNode in pre-order
+		std::vector<int32_t> LODBuckets;            // NiNode children of FirstLOD
+		int32_t AuthoredLODCount = 1;               // most NiNode children on any NiLODNode (at least LOD0)
+		std::unordered_map<const Niflib::NiObject*, int32_t> DataUses;  // geometry nodes referencing each NiGeometryData / NiSkinData
+
+		int32_t Find(const Niflib::NiAVObject* Obj) const;
+		int32_t NumUses(const Niflib::NiObject* Data) const;
+	};
+
+	/**
+	 * Index the graph under every parentless NiAVObject in Blocks (which must hold every object, as ReadNifList
+	 * returns them). HeaderStrings (20.1+ files) seeds the name table in file order.
+	 */
+	void BuildSceneIndex(const std::vector<Niflib::NiObjectRef>& Blocks, const std::vector<std::string>& HeaderStrings,
+		FIsDerivedFn IsDerived, FSceneIndex& Out);
+
+	/** First non-shadow NiTriShape / NiTriStrips in [First, End) of the pre-order, NoIndex if none. */
+	int32_t FindNonShadowTriGeometry(const FSceneIndex& Index, int32_t First, int32_t End);
+
+	/** What SelectLODGeometries picked, with enough detail for the caller to report it. */
+	struct FLODSelection
+	{
+		std::vector<int32_t> GeoNodes;              // geometry nodes in draw order
+		int32_t Bucket = NoIndex;                   // LODBuckets entry used after clamping; NoIndex without a NiLODNode
+		std::vector<int32_t> EmptyChildren;         // children of the bucket without a non-shadow TriShape / TriStrips
+	};
+
+	/**
+	 * Geometry nodes LOD RequestedLOD is built from: each direct child of the NiLODNode bucket (RequestedLOD clamped to
+	 * the buckets, negative = 0) contributes its first non-shadow TriShape / TriStrips. Without a NiLODNode, the
+	 * scene's first one is LOD0. False when that yields no geometry.
+	 */
+	bool SelectLODGeometries(const FSceneIndex& Index, int32_t RequestedLOD, FLODSelection& Out);
+
+	/** Texture file name of the base map of Geo's NiTexturingProperty, empty if none. */
+	std::string GetDiffuseTexturePath(const FSceneIndex& Index, const Niflib::NiGeometry* Geo);
+
+	struct FMaterialSlot
+	{
+		int32_t NameId = NoIndex;
+		std::string DiffuseTexturePath;
+	};
+
+	/** Material slots of one extracted mesh, one per distinct material name (case-insensitive), in first-use order. */
+	struct FMaterialTable
+	{
+		std::vector<FMaterialSlot> Slots;
+		std::unordered_map<int32_t, int32_t> SlotByKeyId;
+
+		/**
+		 * Slot of geometry node NodeIdx, added on first use. A slot without a diffuse texture takes the node's; if both
+		 * have different ones the slot keeps its own and OutConflictPath gets the node's (else it is cleared).
+		 */
+		int32_t Gather(const FSceneIndex& Index, int32_t NodeIdx, std::string& OutConflictPath);
+	};
+}
@@ -0,0 +1,27 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using System.IO;
+using UnrealBuildTool;
+
+public class NiflibRuntime : ModuleRules
+{
+    public NiflibRuntime(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDefinitions.Add("NIFLIB_STATIC_LINK=1");
+        // The local additions in the FILE FOOT CUSTOM CODE sections of inc/obj (the *View accessors and Release*
+        // helpers) are inline, so the prebuilt niflib_static.lib below does not need rebuilding for them
+        PublicIncludePaths.Add(Path.Combine(ModuleDirectory, "inc"));
+        PublicAdditionalLibraries.Add(Path.Combine(ModuleDirectory, "lib", "niflib_static.lib"));
+
+        // Engine-agnostic conversion core (kernels and scene layer), also built standalone by Tools/NifCore
+        PrivateIncludePaths.Add(Path.Combine(ModuleDirectory, "Core"));
+
+        // No editor modules here: this is what packaged games load NIFs with
+        PublicDependencyModuleNames.AddRange(new string[] {
+            "Core", "CoreUObject", "Engine",
+            "ProceduralMeshComponent"   // runtime mesh target for FNifAsyncLoader
+        });
+    }
+}
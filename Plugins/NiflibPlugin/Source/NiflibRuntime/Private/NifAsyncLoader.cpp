@@ -0,0 +1,317 @@
+#include "NifAsyncLoader.h"
+#include "NifReader.h"
+#include "ProceduralMeshComponent.h"
+#include "Async/Async.h"
+#include "Containers/Queue.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/ScopeLock.h"
+
+#include <atomic>
+
+namespace
+{
+    // One material's worth of triangles, already in the layout CreateMeshSection takes
+    struct FNifProcSection
+    {
+        TArray<FVector>          Positions;
+        TArray<FVector>          Normals;
+        TArray<FVector2D>        UVs;
+        TArray<FColor>           Colors;
+        TArray<FProcMeshTangent> Tangents;
+        TArray<int32>            Triangles;
+
+        int64 GetAllocatedSize() const
+        {
+            return Positions.GetAllocatedSize() + Normals.GetAllocatedSize() + UVs.GetAllocatedSize() +
+                Colors.GetAllocatedSize() + Tangents.GetAllocatedSize() + Triangles.GetAllocatedSize();
+        }
+    };
+
+    // Worker side: read + extract one LOD. Streams only need one influence slot, nothing is skinned here.
+    static TSharedPtr<FNifMeshStreams> LoadStreams(const FString& Path, int32 RequestedLOD)
+    {
+        FNifScene* Scene = FNiflibBridge::OpenNifScene(Path, true);
+        if (!Scene)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF][Runtime] Failed to read: %s"), *Path);
+            return nullptr;
+        }
+        FNiflibBridge::ReleaseUnusedLODs(Scene, FMath::Max(0, RequestedLOD), 1);
+
+        TSharedPtr<FNifMeshStreams> Mesh = MakeShared<FNifMeshStreams>();
+        Mesh->MaxInfluences = 1;
+        FNifAnimationData Anim;
+        const bool bOk = FNiflibBridge::ExtractLODStreams(Scene, RequestedLOD, *Mesh, Anim);
+        FNiflibBridge::ReleaseNifScene(Scene);
+
+        if (!bOk || Mesh->NumFaces() == 0)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF][Runtime] No geometry in LOD%d: %s"), RequestedLOD, *Path);
+            return nullptr;
+        }
+        return Mesh;
+    }
+
+    // Worker side: split the streams into one section per material slot
+    static void BuildSections(const FNifMeshStreams& Mesh, TArray<FNifProcSection>& OutSections)
+    {
+        int32 NumSlots = 1;
+        for (int32 Slot : Mesh.FaceMaterials)
+            NumSlots = FMath::Max(NumSlots, Slot + 1);
+        OutSections.SetNum(NumSlots);
+
+        TArray<int32> Remap;
+        for (int32 SlotIdx = 0; SlotIdx < NumSlots; ++SlotIdx)
+        {
+            FNifProcSection& Section = OutSections[SlotIdx];
+            Remap.Init(INDEX_NONE, Mesh.NumVertices());
+
+            for (int32 FaceIdx = 0; FaceIdx < Mesh.NumFaces(); ++FaceIdx)
+            {
+                if (FMath::Max(0, Mesh.FaceMaterials[FaceIdx]) != SlotIdx) continue;
+
+                for (int32 Corner = 0; Corner < 3; ++Corner)
+                {
+                    const int32 V = Mesh.Indices[FaceIdx * 3 + Corner];
+                    if (Remap[V] == INDEX_NONE)
+                    {
+                        Remap[V] = Section.Positions.Num();
+                        Section.Positions.Add(FVector(Mesh.Positions[V]));
+                        Section.Normals.Add(FVector(Mesh.Normals[V]));
+                        Section.UVs.Add(FVector2D(Mesh.UVs[V]));
+                        Section.Colors.Add(Mesh.Colors[V]);
+                        Section.Tangents.Add(FProcMeshTangent(FVector(Mesh.Tangents[V]), false));
+                    }
+                    Section.Triangles.Add(Remap[V]);
+                }
+            }
+        }
+    }
+}
+
+struct UNifAsyncLoader::FRequest
+{
+    FString Path;
+    FTransform Transform;
+    TWeakObjectPtr<AActor> Owner;
+    int32 RequestedLOD = 0;
+    FOnNifMeshLoaded OnLoaded;
+
+    // Filled by the worker
+    TArray<FNifProcSection> Sections;
+    int64 SectionBytes = 0;
+    bool bOk = false;
+    double LoadMs = 0.0;
+};
+
+struct UNifAsyncLoader::FSharedState
+{
+    TQueue<TSharedPtr<FRequest, ESPMode::ThreadSafe>, EQueueMode::Mpsc> Completed;
+    std::atomic<int32> NumInFlight{ 0 };
+    std::atomic<int64> PendingBytes{ 0 };
+
+    // Set once the subsystem is gone; from then on workers fail their requests instead of queueing them
+    FCriticalSection CompletedLock;
+    bool bAbandoned = false;
+};
+
+TFuture<TSharedPtr<FNifMeshStreams>> UNifAsyncLoader::LoadStreamsAsync(const FString& Path, int32 RequestedLOD)
+{
+    FNifReader::EnsureObjectRegistry();
+    return Async(EAsyncExecution::ThreadPool, [Path, RequestedLOD]()
+    {
+        return LoadStreams(Path, RequestedLOD);
+    });
+}
+
+void UNifAsyncLoader::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+    State = MakeShared<FSharedState, ESPMode::ThreadSafe>();
+
+    // niflib fills its type registry lazily on first read; never let two workers race on that
+    FNifReader::EnsureObjectRegistry();
+}
+
+void UNifAsyncLoader::Deinitialize()
+{
+    // Every request still gets its callback (a RequestMeshAsync promise must be set before it is destroyed).
+    // Loads still running keep State alive and fail their requests themselves once they see bAbandoned.
+    if (State.IsValid())
+    {
+        {
+            FScopeLock Lock(&State->CompletedLock);
+            State->bAbandoned = true;
+        }
+
+        TSharedPtr<FRequest, ESPMode::ThreadSafe> Request;
+        while (State->Completed.Dequeue(Request))
+        {
+            Request->OnLoaded.ExecuteIfBound(nullptr);
+        }
+    }
+    for (const TSharedPtr<FRequest, ESPMode::ThreadSafe>& Request : Queued)
+    {
+        Request->OnLoaded.ExecuteIfBound(nullptr);
+    }
+
+    Queued.Reset();
+    State.Reset();
+    Super::Deinitialize();
+}
+
+TStatId UNifAsyncLoader::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNifAsyncLoader, STATGROUP_Tickables);
+}
+
+void UNifAsyncLoader::RequestMesh(const FString& Path, const FTransform& Transform, FOnNifMeshLoaded OnLoaded, AActor* Owner, int32 RequestedLOD)
+{
+    check(IsInGameThread());
+
+    TSharedPtr<FRequest, ESPMode::ThreadSafe> Request = MakeShared<FRequest, ESPMode::ThreadSafe>();
+    Request->Path = Path;
+    Request->Transform = Transform;
+    Request->Owner = Owner;
+    Request->RequestedLOD = RequestedLOD;
+    Request->OnLoaded = MoveTemp(OnLoaded);
+    Queued.Add(MoveTemp(Request));
+
+    StartQueuedLoads();
+}
+
+TFuture<UProceduralMeshComponent*> UNifAsyncLoader::RequestMeshAsync(const FString& Path, const FTransform& Transform, AActor* Owner, int32 RequestedLOD)
+{
+    TSharedRef<TPromise<UProceduralMeshComponent*>> Promise = MakeShared<TPromise<UProceduralMeshComponent*>>();
+    TFuture<UProceduralMeshComponent*> Future = Promise->GetFuture();
+    RequestMesh(Path, Transform, FOnNifMeshLoaded::CreateLambda([Promise](UProceduralMeshComponent* Component)
+    {
+        Promise->SetValue(Component);
+    }), Owner, RequestedLOD);
+    return Future;
+}
+
+int32 UNifAsyncLoader::GetNumPending() const
+{
+    return Queued.Num() + (State.IsValid() ? State->NumInFlight.load() : 0);
+}
+
+void UNifAsyncLoader::StartQueuedLoads()
+{
+    const int64 MaxPendingBytes = (int64)FMath::Max(1, Budget.MaxPendingMegabytes) * 1024 * 1024;
+    const int32 MaxConcurrent = FMath::Max(1, Budget.MaxConcurrentLoads);
+
+    while (Queued.Num() > 0 &&
+        State->NumInFlight.load() < MaxConcurrent &&
+        State->PendingBytes.load() < MaxPendingBytes)
+    {
+        TSharedPtr<FRequest, ESPMode::ThreadSafe> Request = Queued[0];
+        Queued.RemoveAt(0, 1, false);
+
+        ++State->NumInFlight;
+        Async(EAsyncExecution::ThreadPool, [Request, SharedState = State]()
+        {
+            const uint64 StartCycles = FPlatformTime::Cycles64();
+            if (TSharedPtr<FNifMeshStreams> Mesh = LoadStreams(Request->Path, Request->RequestedLOD))
+            {
+                BuildSections(*Mesh, Request->Sections);
+                for (const FNifProcSection& Section : Request->Sections)
+                    Request->SectionBytes += Section.GetAllocatedSize();
+                Request->bOk = true;
+            }
+            Request->LoadMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+            bool bAbandoned = false;
+            {
+                FScopeLock Lock(&SharedState->CompletedLock);
+                bAbandoned = SharedState->bAbandoned;
+                if (!bAbandoned)
+                {
+                    SharedState->PendingBytes += Request->SectionBytes;
+                    SharedState->Completed.Enqueue(Request);
+                }
+            }
+            if (bAbandoned)
+            {
+                // The world is gone; fail the request on the game thread, where OnLoaded always fires
+                Request->Sections.Empty();
+                AsyncTask(ENamedThreads::GameThread, [Request]()
+                {
+                    Request->OnLoaded.ExecuteIfBound(nullptr);
+                });
+            }
+            --SharedState->NumInFlight;
+        });
+    }
+}
+
+void UNifAsyncLoader::Tick(float DeltaTime)
+{
+    if (!State.IsValid()) return;
+
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    const double BudgetMs = FMath::Max(0.0f, Budget.GameThreadMsPerFrame);
+
+    TSharedPtr<FRequest, ESPMode::ThreadSafe> Request;
+    int32 NumSpawned = 0;
+    while ((NumSpawned == 0 || FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) < BudgetMs) &&
+        State->Completed.Dequeue(Request))
+    {
+        SpawnLoaded(*Request);
+        State->PendingBytes -= Request->SectionBytes;
+        ++NumSpawned;
+    }
+
+    StartQueuedLoads();
+}
+
+void UNifAsyncLoader::SpawnLoaded(FRequest& Request)
+{
+    UWorld* World = GetWorld();
+    if (!Request.bOk || !World)
+    {
+        Request.OnLoaded.ExecuteIfBound(nullptr);
+        return;
+    }
+
+    const uint64 SpawnStartCycles = FPlatformTime::Cycles64();
+
+    AActor* Owner = Request.Owner.Get();
+    if (!Owner)
+    {
+        Owner = World->SpawnActor<AActor>(AActor::StaticClass(), Request.Transform);
+        if (!Owner)
+        {
+            Request.OnLoaded.ExecuteIfBound(nullptr);
+            return;
+        }
+    }
+
+    UProceduralMeshComponent* Component = NewObject<UProceduralMeshComponent>(Owner);
+    if (USceneComponent* Root = Owner->GetRootComponent())
+    {
+        Component->SetupAttachment(Root);
+    }
+    else
+    {
+        Owner->SetRootComponent(Component);
+        Component->SetWorldTransform(Request.Transform);
+    }
+    Component->RegisterComponent();
+
+    for (int32 SectionIdx = 0; SectionIdx < Request.Sections.Num(); ++SectionIdx)
+    {
+        const FNifProcSection& Section = Request.Sections[SectionIdx];
+        if (Section.Triangles.Num() == 0) continue;
+
+        Component->CreateMeshSection(SectionIdx, Section.Positions, Section.Triangles, Section.Normals,
+            Section.UVs, Section.Colors, Section.Tangents, false);
+    }
+    Request.Sections.Empty();
+
+    UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Runtime load '%s' Load=%.3f ms (worker) Spawn=%.3f ms (game thread)"),
+        *Request.Path, Request.LoadMs, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SpawnStartCycles));
+
+    Request.OnLoaded.ExecuteIfBound(Component);
+}
@@ -0,0 +1,217 @@
+#include "NifMeshCache.h"
+#include "NifReader.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Hash/CityHash.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace
+{
+    static constexpr uint32 CacheMagic = 0x43464E4E;   // 'NNFC'
+    static constexpr uint32 CacheVersion = 5;           // Bump whenever the layout or extraction output changes
+
+    static FString GetEntryPath(uint64 Key)
+    {
+        return FPaths::ProjectIntermediateDir() / TEXT("NifCache") / FString::Printf(TEXT("%016llx.nifc"), Key);
+    }
+
+    // Count + raw element bytes. Only used for the trivially copyable vertex/index streams.
+    template <typename T>
+    static void SerializeRaw(FArchive& Ar, TArray<T>& Array)
+    {
+        static_assert(TIsTriviallyDestructible<T>::Value, "raw stream must be POD");
+
+        int32 Num = Array.Num();
+        Ar << Num;
+        if (Ar.IsLoading())
+        {
+            if (Num < 0 || (int64)Num * (int64)sizeof(T) > Ar.TotalSize() - Ar.Tell())
+            {
+                Ar.SetError();
+                return;
+            }
+            Array.SetNumUninitialized(Num);
+        }
+        Ar.Serialize(Array.GetData(), (int64)Num * sizeof(T));
+    }
+
+    static void SerializeLOD(FArchive& Ar, FNifMeshStreams& Mesh)
+    {
+        Ar << Mesh.MaxInfluences;
+
+        SerializeRaw(Ar, Mesh.Positions);
+        SerializeRaw(Ar, Mesh.Normals);
+        SerializeRaw(Ar, Mesh.UVs);
+        SerializeRaw(Ar, Mesh.Colors);
+        SerializeRaw(Ar, Mesh.Tangents);
+        SerializeRaw(Ar, Mesh.Bitangents);
+        SerializeRaw(Ar, Mesh.BoneIndices);
+        SerializeRaw(Ar, Mesh.BoneWeights);
+        SerializeRaw(Ar, Mesh.Indices);
+        SerializeRaw(Ar, Mesh.FaceMaterials);
+
+        int32 NumMaterials = Mesh.Materials.Num();
+        Ar << NumMaterials;
+        if (Ar.IsLoading())
+        {
+            if (NumMaterials < 0 || Ar.IsError()) { Ar.SetError(); return; }
+            Mesh.Materials.SetNum(NumMaterials);
+        }
+        for (FNifMaterial& M : Mesh.Materials)
+        {
+            Ar << M.Name << M.DiffuseTexturePath;
+        }
+
+        int32 NumBones = Mesh.Bones.Num();
+        Ar << NumBones;
+        if (Ar.IsLoading())
+        {
+            if (NumBones < 0 || Ar.IsError()) { Ar.SetError(); return; }
+            Mesh.Bones.SetNum(NumBones);
+        }
+        for (FNifBone& B : Mesh.Bones)
+        {
+            Ar << B.Name << B.ParentIndex << B.BindPose;
+        }
+    }
+
+    static void SerializeAnim(FArchive& Ar, FNifAnimationData& Anim)
+    {
+        Ar << Anim.Name << Anim.Duration << Anim.SampleRate << Anim.NumFrames;
+
+        int32 NumTracks = Anim.Tracks.Num();
+        Ar << NumTracks;
+        if (Ar.IsLoading())
+        {
+            if (NumTracks < 0 || Ar.IsError()) { Ar.SetError(); return; }
+            Anim.Tracks.SetNum(NumTracks);
+        }
+        for (FNifKeyframeTrack& Track : Anim.Tracks)
+        {
+            Ar << Track.BoneIndex << Track.BoneName;
+            SerializeRaw(Ar, Track.Times);
+            SerializeRaw(Ar, Track.Translations);
+            SerializeRaw(Ar, Track.Rotations);
+            SerializeRaw(Ar, Track.Scales);
+            if (Ar.IsError()) return;
+        }
+    }
+
+    // Every per-vertex stream must match the position count, or the entry is unusable
+    static bool IsConsistent(const FNifMeshStreams& Mesh)
+    {
+        const int32 NV = Mesh.NumVertices();
+        return Mesh.MaxInfluences > 0
+            && Mesh.Normals.Num() == NV && Mesh.UVs.Num() == NV && Mesh.Colors.Num() == NV
+            && Mesh.Tangents.Num() == NV && Mesh.Bitangents.Num() == NV
+            && Mesh.BoneIndices.Num() == NV * Mesh.MaxInfluences && Mesh.BoneWeights.Num() == NV * Mesh.MaxInfluences
+            && Mesh.Indices.Num() == Mesh.NumFaces() * 3;
+    }
+}
+
+namespace FNifMeshCache
+{
+    uint64 ComputeKey(const FString& SourcePath, uint64 SettingsKey)
+    {
+        FNifMappedFile File;
+        if (!File.Open(SourcePath)) return 0;
+
+        // CityHash64 takes a 32-bit length; hash in 1 GB slices so large archives still key correctly
+        static constexpr int64 SliceBytes = 1ll << 30;
+        uint64 Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&SettingsKey), sizeof(SettingsKey), CacheVersion);
+        for (int64 Offset = 0; Offset < File.GetSize(); Offset += SliceBytes)
+        {
+            const int64 Len = FMath::Min(SliceBytes, File.GetSize() - Offset);
+            Hash = CityHash64WithSeed(reinterpret_cast<const char*>(File.GetData() + Offset), (uint32)Len, Hash);
+        }
+        return Hash != 0 ? Hash : 1;
+    }
+
+    bool Load(uint64 Key, TArray<FNifMeshStreams>& OutLODs, TArray<FNifAnimationData>& OutAnims)
+    {
+        OutLODs.Reset();
+        OutAnims.Reset();
+        if (Key == 0) return false;
+
+        const FString EntryPath = GetEntryPath(Key);
+        if (!IFileManager::Get().FileExists(*EntryPath)) return false;
+
+        FNifMappedFile File;
+        if (!File.Open(EntryPath)) return false;
+
+        FMemoryReaderView Ar(TArrayView64<const uint8>(File.GetData(), File.GetSize()));
+
+        uint32 Magic = 0, Version = 0;
+        uint64 StoredKey = 0;
+        int32 NumLODs = 0, NumAnims = 0;
+        Ar << Magic << Version << StoredKey << NumLODs << NumAnims;
+        if (Ar.IsError() || Magic != CacheMagic || Version != CacheVersion || StoredKey != Key || NumLODs <= 0 || NumAnims < 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF][Cache] Ignoring stale entry %s"), *EntryPath);
+            return false;
+        }
+
+        OutLODs.SetNum(NumLODs);
+        for (FNifMeshStreams& Mesh : OutLODs)
+        {
+            SerializeLOD(Ar, Mesh);
+            if (Ar.IsError() || !IsConsistent(Mesh))
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF][Cache] Ignoring corrupt entry %s"), *EntryPath);
+                OutLODs.Reset();
+                return false;
+            }
+        }
+
+        OutAnims.SetNum(NumAnims);
+        for (FNifAnimationData& Anim : OutAnims)
+        {
+            SerializeAnim(Ar, Anim);
+            if (Ar.IsError())
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF][Cache] Ignoring corrupt entry %s"), *EntryPath);
+                OutLODs.Reset();
+                OutAnims.Reset();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Store(uint64 Key, const TArray<FNifMeshStreams>& LODs, const TArray<FNifAnimationData>& Anims)
+    {
+        if (Key == 0 || LODs.Num() == 0) return false;
+
+        TArray<uint8> Bytes;
+        FMemoryWriter Ar(Bytes);
+
+        uint32 Magic = CacheMagic, Version = CacheVersion;
+        int32 NumLODs = LODs.Num(), NumAnims = Anims.Num();
+        Ar << Magic << Version << Key << NumLODs << NumAnims;
+        // Saving never modifies the payload
+        for (const FNifMeshStreams& Mesh : LODs)
+        {
+            SerializeLOD(Ar, const_cast<FNifMeshStreams&>(Mesh));
+        }
+        for (const FNifAnimationData& Anim : Anims)
+        {
+            SerializeAnim(Ar, const_cast<FNifAnimationData&>(Anim));
+        }
+
+        const FString EntryPath = GetEntryPath(Key);
+        const FString TempPath = EntryPath + FString::Printf(TEXT(".%u.tmp"), FPlatformTLS::GetCurrentThreadId());
+        if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF][Cache] Failed to write %s"), *TempPath);
+            return false;
+        }
+        if (!IFileManager::Get().Move(*EntryPath, *TempPath, true, true))
+        {
+            IFileManager::Get().Delete(*TempPath, false, false, true);
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "NiflibBridge.h"
+
+/**
+ * Content-addressed on-disk cache of extracted LOD payloads and animation clips (Intermediate/NifCache).
+ * Entries are keyed by a hash of the .nif bytes plus every setting that changes extraction output,
+ * so a changed source or setting simply misses; nothing is ever invalidated in place.
+ */
+namespace FNifMeshCache
+{
+	/** Hash the file's bytes together with SettingsKey. Returns 0 if the file cannot be read. */
+	uint64 ComputeKey(const FString& SourcePath, uint64 SettingsKey);
+
+	/** Memory-map the entry for Key and decode it into OutLODs/OutAnims. False on miss or a stale/corrupt entry. */
+	bool Load(uint64 Key, TArray<FNifMeshStreams>& OutLODs, TArray<FNifAnimationData>& OutAnims);
+
+	/** Write LODs + clips as the entry for Key (temp file + rename, so concurrent writers never expose partial entries). */
+	bool Store(uint64 Key, const TArray<FNifMeshStreams>& LODs, const TArray<FNifAnimationData>& Anims);
+}
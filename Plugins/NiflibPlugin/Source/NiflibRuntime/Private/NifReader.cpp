@@ -0,0 +1,524 @@
+#include "NifReader.h"
+#include "NifTypeIndex.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/LowLevelMemTracker.h"
+
+#include <atomic>
+#include <istream>
+#include <sstream>
+#include <list>
+#include <map>
+
+#include <NIF_IO.h>
+#include <ObjectRegistry.h>
+#include <gen/Header.h>
+#include <obj/NiNode.h>
+#include <obj/NiGeometryData.h>
+#include <obj/NiSkinData.h>
+#include <obj/NiSkinPartition.h>
+#include <obj/NiKeyframeData.h>
+#include <obj/NiBSplineData.h>
+
+using namespace Niflib;
+
+// ---------- FNifMemoryStreamBuf ----------
+
+FNifMemoryStreamBuf::FNifMemoryStreamBuf(const uint8* Data, int64 Size)
+{
+    char_type* Begin = reinterpret_cast<char_type*>(const_cast<uint8*>(Data));
+    setg(Begin, Begin, Begin + Size);
+}
+
+std::streamsize FNifMemoryStreamBuf::xsgetn(char_type* Dest, std::streamsize Count)
+{
+    const std::streamsize Avail = egptr() - gptr();
+    const std::streamsize N = FMath::Min(Count, Avail);
+    if (N > 0)
+    {
+        FMemory::Memcpy(Dest, gptr(), (SIZE_T)N);
+        gbump((int)N);
+    }
+    return N;
+}
+
+FNifMemoryStreamBuf::pos_type FNifMemoryStreamBuf::seekoff(off_type Off, std::ios_base::seekdir Dir, std::ios_base::openmode Which)
+{
+    if (!(Which & std::ios_base::in)) return pos_type(off_type(-1));
+
+    off_type Target = Off;
+    if (Dir == std::ios_base::cur) Target += gptr() - eback();
+    else if (Dir == std::ios_base::end) Target += egptr() - eback();
+
+    if (Target < 0 || Target > egptr() - eback()) return pos_type(off_type(-1));
+
+    setg(eback(), eback() + Target, egptr());
+    return pos_type(Target);
+}
+
+FNifMemoryStreamBuf::pos_type FNifMemoryStreamBuf::seekpos(pos_type Pos, std::ios_base::openmode Which)
+{
+    return seekoff(off_type(Pos), std::ios_base::beg, Which);
+}
+
+// ---------- FNifMappedFile ----------
+
+FNifMappedFile::FNifMappedFile() = default;
+
+FNifMappedFile::~FNifMappedFile()
+{
+    // Region must go before the handle that owns the mapping
+    Region.Reset();
+    Handle.Reset();
+}
+
+bool FNifMappedFile::Open(const FString& Path)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+    Handle.Reset(PlatformFile.OpenMapped(*Path));
+    if (Handle.IsValid())
+    {
+        Region.Reset(Handle->MapRegion(0, Handle->GetFileSize()));
+        if (Region.IsValid())
+        {
+            Data = Region->GetMappedPtr();
+            Size = Region->GetMappedSize();
+            return Size > 0;
+        }
+        Handle.Reset();
+    }
+
+    // No mapping support (e.g. some pak/virtual file layers): one bulk read instead
+    if (!FFileHelper::LoadFileToArray(Fallback, *Path))
+    {
+        return false;
+    }
+    Data = Fallback.GetData();
+    Size = Fallback.Num();
+    return Size > 0;
+}
+
+// ---------- block decoding ----------
+
+namespace
+{
+    // Below this many blocks the task dispatch costs more than it saves
+    static constexpr int32 MinBlocksForParallelDecode = 64;
+
+    // Stream over one slice of the file, set up the way ReadNifList sets up its stream (header for IndexString lookups).
+    struct FBlockStream
+    {
+        FNifMemoryStreamBuf Buf;
+        std::istream In;
+
+        FBlockStream(const uint8* Data, int64 Size, Header& Hdr)
+            : Buf(Data, Size)
+            , In(&Buf)
+        {
+            hdrInfo HdrInfo(&Hdr);
+            In >> HdrInfo;
+        }
+    };
+
+    // Bulk payloads a lazy read leaves for later; everything else (the graph's structure) is decoded up front
+    static bool IsDeferredBlock(NiObject* Obj)
+    {
+        return NifCast<NiGeometryData>(Obj) || NifCast<NiSkinData>(Obj) || NifCast<NiSkinPartition>(Obj) ||
+            NifCast<NiKeyframeData>(Obj) || NifCast<NiBSplineData>(Obj);
+    }
+
+    /**
+     * Two-pass decode for files whose header lists every block's byte size (20.2.0.7+):
+     * blocks are created in file order, their payloads decoded in parallel (each with its own link stack),
+     * then FixLinks resolves references serially once every object exists.
+     * With OutLazy, heavy data blocks are only created; OutLazy takes over *LazyFile and decodes them on demand.
+     * Returns false if the file does not qualify or a block does not match its declared size; the caller then uses the
+     * serial reader.
+     */
+    static bool ReadBlocksParallel(const uint8* Data, int64 Size, std::vector<NiObjectRef>& OutObjects, NifInfo& OutInfo,
+        std::vector<std::string>* OutStrings, FNifLazyBlocks* OutLazy = nullptr, TUniquePtr<FNifMappedFile>* LazyFile = nullptr)
+    {
+        Header Hdr;
+        int64 BlockStart = 0;
+        {
+            FBlockStream HeaderStream(Data, Size, Hdr);
+            OutInfo = Hdr.Read(HeaderStream.In);
+            if (!HeaderStream.In.good()) return false;
+            BlockStart = (int64)HeaderStream.In.tellg();
+        }
+        if (OutStrings)
+        {
+            *OutStrings = Hdr.strings;
+        }
+
+        const int32 NumBlocks = (int32)Hdr.numBlocks;
+        if (Hdr.version < VER_20_2_0_7 || (!OutLazy && NumBlocks < MinBlocksForParallelDecode) ||
+            (int32)Hdr.blockSize.size() != NumBlocks || (int32)Hdr.blockTypeIndex.size() != NumBlocks)
+        {
+            return false;
+        }
+
+        // Byte range of every block from the header sizes
+        TArray<int64> Offsets;
+        Offsets.SetNumUninitialized(NumBlocks + 1);
+        Offsets[0] = BlockStart;
+        for (int32 i = 0; i < NumBlocks; ++i)
+        {
+            Offsets[i + 1] = Offsets[i] + (int64)Hdr.blockSize[i];
+        }
+        if (Offsets[NumBlocks] > Size)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] Block sizes run past end of file (%lld > %lld); using serial reader."), Offsets[NumBlocks], Size);
+            return false;
+        }
+
+        // Resolve each listed type once: one instance through niflib's registry tells whether niflib knows the type at
+        // all, gives its Type for the type index, and becomes the first block of that type
+        const uint64 CreateStartCycles = FPlatformTime::Cycles64();
+        std::vector<NiObjectRef> FirstOfType(Hdr.blockTypes.size());
+        std::vector<bool> FirstUsed(Hdr.blockTypes.size(), false);
+        for (size_t t = 0; t < Hdr.blockTypes.size(); ++t)
+        {
+            FirstOfType[t] = ObjectRegistry::CreateObject(Hdr.blockTypes[t]);
+            if (FirstOfType[t])
+            {
+                FNifTypeIndex::Register(FirstOfType[t]->GetType());
+            }
+        }
+
+        // Create every object up front (creation stays on this thread)
+        OutObjects.assign(NumBlocks, NiObjectRef());
+        for (int32 i = 0; i < NumBlocks; ++i)
+        {
+            const unsigned int TypeIdx = Hdr.blockTypeIndex[i] & 0x7FFF;
+            if (TypeIdx >= Hdr.blockTypes.size()) return false;
+
+            if (!FirstOfType[TypeIdx])
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF] Unknown block type '%s'; using serial reader."),
+                    UTF8_TO_TCHAR(Hdr.blockTypes[TypeIdx].c_str()));
+                return false;
+            }
+            OutObjects[i] = FirstUsed[TypeIdx] ? NiObjectRef(ObjectRegistry::CreateObject(Hdr.blockTypes[TypeIdx])) : FirstOfType[TypeIdx];
+            FirstUsed[TypeIdx] = true;
+        }
+
+        const double CreateMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CreateStartCycles);
+
+        TArray<int32> Decoded;
+        Decoded.Reserve(NumBlocks);
+        for (int32 i = 0; i < NumBlocks; ++i)
+        {
+            if (!OutLazy || !IsDeferredBlock(OutObjects[i]))
+            {
+                Decoded.Add(i);
+            }
+        }
+
+        // Decode payloads; each block only touches its own object and link stack
+        std::vector<std::list<unsigned int>> LinkStacks(NumBlocks);
+        std::atomic<int32> SizeMismatches{ 0 };
+        const NifInfo Info = OutInfo;
+        ParallelFor(Decoded.Num(), [&](int32 j)
+        {
+            LLM_SCOPE_BYNAME(TEXT("Nif/Open"));   // memory tags do not follow work onto task threads
+            const int32 i = Decoded[j];
+            FBlockStream BlockStream(Data + Offsets[i], Offsets[i + 1] - Offsets[i], Hdr);
+            OutObjects[i]->Read(BlockStream.In, LinkStacks[i], Info);
+            if ((int64)BlockStream.In.tellg() != Offsets[i + 1] - Offsets[i])
+            {
+                ++SizeMismatches;
+            }
+        }, Decoded.Num() < MinBlocksForParallelDecode ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+        // A block that reads more or less than the header says was decoded wrongly (or the sizes are wrong); niflib's
+        // serial reader does not depend on them, so let it have the whole file
+        if (SizeMismatches.load() > 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF] %d block(s) did not consume their declared size; using serial reader."), SizeMismatches.load());
+            OutObjects.clear();
+            return false;
+        }
+
+        // Second pass: resolve links now that every object exists
+        map<unsigned int, NiObjectRef> ObjectMap;
+        for (int32 i = 0; i < NumBlocks; ++i)
+        {
+            ObjectMap[(unsigned int)i] = OutObjects[i];
+        }
+        list<NiObjectRef> MissingLinkStack;
+        for (int32 i : Decoded)
+        {
+            OutObjects[i]->FixLinks(ObjectMap, LinkStacks[i], MissingLinkStack, Info);
+        }
+
+        if (OutLazy)
+        {
+            TArray<NiObject*> Blocks;
+            Blocks.SetNumUninitialized(NumBlocks);
+            for (int32 i = 0; i < NumBlocks; ++i)
+            {
+                Blocks[i] = OutObjects[i];
+            }
+            OutLazy->Adopt(MoveTemp(*LazyFile), Hdr, Info, MoveTemp(Blocks), MoveTemp(Offsets));
+            for (int32 i = 0, d = 0; i < NumBlocks; ++i)
+            {
+                if (d < Decoded.Num() && Decoded[d] == i) { ++d; continue; }
+                OutLazy->Defer(i);
+            }
+        }
+
+        UE_LOG(LogTemp, Verbose, TEXT("[NIF] Parallel decode: %d of %d blocks (%d types, created in %.3f ms)"),
+            Decoded.Num(), NumBlocks, (int32)Hdr.blockTypes.size(), CreateMs);
+        return true;
+    }
+
+    // Header-only parse for the serial path, which cannot hand out niflib's header
+    static void ReadHeaderStrings(const uint8* Data, int64 Size, std::vector<std::string>& OutStrings)
+    {
+        Header Hdr;
+        FBlockStream HeaderStream(Data, Size, Hdr);
+        Hdr.Read(HeaderStream.In);
+        if (HeaderStream.In.good())
+        {
+            OutStrings = std::move(Hdr.strings);
+        }
+    }
+
+    // niflib's own reader over the mapped bytes, for files the block-parallel path does not take
+    static std::vector<NiObjectRef> ReadBlocksSerial(const FNifMappedFile& File, NifInfo& OutInfo, std::vector<std::string>* OutStrings)
+    {
+        if (OutStrings && OutStrings->empty())
+        {
+            ReadHeaderStrings(File.GetData(), File.GetSize(), *OutStrings);
+        }
+
+        FNifMemoryStreamBuf Buf(File.GetData(), File.GetSize());
+        std::istream In(&Buf);
+        std::vector<NiObjectRef> Objects = ReadNifList(In, &OutInfo);
+
+        // niflib created these without us seeing their types; number them for the casts that follow
+        const Type* LastType = nullptr;
+        for (const NiObjectRef& Obj : Objects)
+        {
+            const Type* BlockType = &Obj->GetType();
+            if (BlockType != LastType)
+            {
+                FNifTypeIndex::Register(*BlockType);
+                LastType = BlockType;
+            }
+        }
+        return Objects;
+    }
+}
+
+// ---------- FNifLazyBlocks ----------
+
+FNifLazyBlocks::FNifLazyBlocks() = default;
+
+FNifLazyBlocks::~FNifLazyBlocks() = default;
+
+void FNifLazyBlocks::Adopt(TUniquePtr<FNifMappedFile> InFile, const Header& InHeader, const NifInfo& InInfo,
+    TArray<NiObject*>&& InBlocks, TArray<int64>&& InOffsets)
+{
+    File = MoveTemp(InFile);
+    Hdr = MakeUnique<Header>(InHeader);
+    Info = InInfo;
+    Blocks = MoveTemp(InBlocks);
+    Offsets = MoveTemp(InOffsets);
+    Pending.Reset();
+    PendingBytes = 0;
+    DecodedBytes = 0;
+    DecodedBlocks = 0;
+    bFailed = false;
+}
+
+void FNifLazyBlocks::Defer(int32 BlockIndex)
+{
+    Pending.Add(Blocks[BlockIndex], BlockIndex);
+    PendingBytes += Offsets[BlockIndex + 1] - Offsets[BlockIndex];
+}
+
+bool FNifLazyBlocks::EnsureDecoded(TConstArrayView<NiObject*> Objects)
+{
+    if (bFailed) return false;
+    if (Pending.Num() == 0) return true;
+
+    TArray<int32> BlockIndices;
+    for (const NiObject* Obj : Objects)
+    {
+        if (const int32* Found = Pending.Find(Obj))
+        {
+            BlockIndices.AddUnique(*Found);
+        }
+    }
+    return DecodeBlocks(BlockIndices);
+}
+
+bool FNifLazyBlocks::EnsureDecodedOfType(const Type& BaseType)
+{
+    if (bFailed) return false;
+
+    TArray<int32> BlockIndices;
+    for (const TPair<const NiObject*, int32>& Entry : Pending)
+    {
+        if (FNifTypeIndex::IsDerived(Entry.Key->GetType(), BaseType))
+        {
+            BlockIndices.Add(Entry.Value);
+        }
+    }
+    BlockIndices.Sort();
+    return DecodeBlocks(BlockIndices);
+}
+
+bool FNifLazyBlocks::Discard(const NiObject* Object)
+{
+    int32 BlockIndex = INDEX_NONE;
+    if (!Pending.RemoveAndCopyValue(Object, BlockIndex)) return false;
+
+    PendingBytes -= Offsets[BlockIndex + 1] - Offsets[BlockIndex];
+    return true;
+}
+
+bool FNifLazyBlocks::DecodeBlocks(const TArray<int32>& BlockIndices)
+{
+    if (BlockIndices.Num() == 0) return true;
+    LLM_SCOPE_BYNAME(TEXT("Nif/Decode"));
+    FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+
+    // Same two passes as the reader: payloads in parallel (heavy blocks are worth it even a few at a time), then links
+    std::vector<std::list<unsigned int>> LinkStacks(BlockIndices.Num());
+    std::atomic<int32> SizeMismatches{ 0 };
+    ParallelFor(BlockIndices.Num(), [&](int32 j)
+    {
+        LLM_SCOPE_BYNAME(TEXT("Nif/Decode"));
+        const int32 i = BlockIndices[j];
+        FBlockStream BlockStream(File->GetData() + Offsets[i], Offsets[i + 1] - Offsets[i], *Hdr);
+        Blocks[i]->Read(BlockStream.In, LinkStacks[j], Info);
+        if ((int64)BlockStream.In.tellg() != Offsets[i + 1] - Offsets[i])
+        {
+            ++SizeMismatches;
+        }
+    }, BlockIndices.Num() > 1 ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+
+    // The structure was read long ago and cannot fall back to the serial reader now; the whole graph is suspect
+    if (SizeMismatches.load() > 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("[NIF] Lazy decode: %d block(s) did not consume their declared size; giving up on this file."), SizeMismatches.load());
+        bFailed = true;
+        return false;
+    }
+
+    // Only the blocks these link to go into the map, not the whole file
+    map<unsigned int, NiObjectRef> ObjectMap;
+    for (const std::list<unsigned int>& Links : LinkStacks)
+    {
+        for (unsigned int Link : Links)
+        {
+            if (Link < (unsigned int)Blocks.Num()) ObjectMap[Link] = Blocks[Link];
+        }
+    }
+    list<NiObjectRef> MissingLinkStack;
+    int64 Bytes = 0;
+    for (int32 j = 0; j < BlockIndices.Num(); ++j)
+    {
+        const int32 i = BlockIndices[j];
+        Blocks[i]->FixLinks(ObjectMap, LinkStacks[j], MissingLinkStack, Info);
+        Pending.Remove(Blocks[i]);
+        Bytes += Offsets[i + 1] - Offsets[i];
+    }
+    PendingBytes -= Bytes;
+    DecodedBytes += Bytes;
+    DecodedBlocks += BlockIndices.Num();
+
+    UE_LOG(LogTemp, Verbose, TEXT("[NIF] Lazy decode: %d blocks (%lld bytes) in %.3f ms; %d still pending (%lld bytes)"),
+        BlockIndices.Num(), Bytes, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles), Pending.Num(), PendingBytes);
+    return true;
+}
+
+// ---------- FNifReader ----------
+
+namespace FNifReader
+{
+    FCriticalSection& GetNiflibLock()
+    {
+        static FCriticalSection Lock;
+        return Lock;
+    }
+
+    void EnsureObjectRegistry()
+    {
+        FScopeLock NiflibLock(&GetNiflibLock());
+
+        // niflib's registry is filled by RegisterObjects() (src/gen/register.cpp), which is not in the public headers;
+        // the only way in is ReadNifList(istream&, NifInfo*), which calls it once behind the file-static
+        // g_objects_registered flag in src/niflib.cpp before it reads anything. An empty stream would make ReadNifList
+        // throw, so feed it the smallest valid file: one NiNode written by niflib itself. If a niflib update moves
+        // registration elsewhere, the CreateObject check below fires.
+        static const bool bRegistered = []()
+        {
+            std::stringstream Probe;
+            NiNodeRef Node = new NiNode;
+            WriteNifTree(Probe, Node, NifInfo());
+            Probe.seekg(0);
+            ReadNifList(Probe);
+
+            NiObjectRef Check = ObjectRegistry::CreateObject(NiNode::TYPE.GetTypeName());
+            return Check != nullptr;
+        }();
+        ensureMsgf(bRegistered, TEXT("[NIF] niflib's block registry is still empty after a ReadNifList; block creation will fail"));
+    }
+
+    std::vector<NiObjectRef> ReadNifListMapped(const FString& Path, NifInfo& OutInfo, bool bParallelBlocks, std::vector<std::string>* OutStrings)
+    {
+        FNifMappedFile File;
+        if (!File.Open(Path))
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Could not open %s"), *Path);
+            return std::vector<NiObjectRef>();
+        }
+
+        // Every path below creates blocks through the registry; it must be filled before any of them runs
+        FScopeLock NiflibLock(&GetNiflibLock());
+        EnsureObjectRegistry();
+
+        if (bParallelBlocks)
+        {
+            std::vector<NiObjectRef> Objects;
+            if (ReadBlocksParallel(File.GetData(), File.GetSize(), Objects, OutInfo, OutStrings))
+            {
+                return Objects;
+            }
+        }
+
+        return ReadBlocksSerial(File, OutInfo, OutStrings);
+    }
+
+    std::vector<NiObjectRef> ReadNifListLazy(const FString& Path, NifInfo& OutInfo, FNifLazyBlocks& OutLazy, std::vector<std::string>* OutStrings)
+    {
+        TUniquePtr<FNifMappedFile> File = MakeUnique<FNifMappedFile>();
+        if (!File->Open(Path))
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Could not open %s"), *Path);
+            return std::vector<NiObjectRef>();
+        }
+
+        FScopeLock NiflibLock(&GetNiflibLock());
+        EnsureObjectRegistry();
+
+        // The file moves into OutLazy only on success; the serial fallback still reads from it
+        const FNifMappedFile& Bytes = *File;
+        std::vector<NiObjectRef> Objects;
+        if (ReadBlocksParallel(Bytes.GetData(), Bytes.GetSize(), Objects, OutInfo, OutStrings, &OutLazy, &File))
+        {
+            return Objects;
+        }
+
+        return ReadBlocksSerial(Bytes, OutInfo, OutStrings);
+    }
+}
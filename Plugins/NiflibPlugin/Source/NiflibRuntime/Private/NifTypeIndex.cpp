@@ -0,0 +1,92 @@
+#include "NifTypeIndex.h"
+
+using namespace Niflib;
+
+namespace
+{
+    // Every type registered so far, by Type::internal_type_number
+    static TArray<const Type*> GKnownTypes;
+    static bool GTypeIndexDisabled = false;
+
+    // Preorder-number every known type; a type's Last is set once its whole subtree has been numbered
+    static void Renumber()
+    {
+        TArray<TArray<int32>> Children;
+        Children.SetNum(GKnownTypes.Num());
+        TArray<int32> Roots;
+        for (int32 Number = 0; Number < GKnownTypes.Num(); ++Number)
+        {
+            const Type* T = GKnownTypes[Number];
+            if (!T) continue;
+            if (T->base_type) Children[T->base_type->internal_type_number].Add(Number);
+            else Roots.Add(Number);
+        }
+
+        TArray<FNifTypeIndex::FInterval> Numbered;
+        Numbered.SetNum(GKnownTypes.Num());
+        TArray<TPair<int32, bool>> Stack;   // (type number, subtree done)
+        for (int32 r = Roots.Num() - 1; r >= 0; --r)
+        {
+            Stack.Emplace(Roots[r], false);
+        }
+        int32 Next = 0;
+        while (Stack.Num() > 0)
+        {
+            const TPair<int32, bool> Entry = Stack.Pop(false);
+            if (Entry.Value)
+            {
+                Numbered[Entry.Key].Last = Next - 1;
+                continue;
+            }
+            Numbered[Entry.Key].First = Next++;
+            Stack.Emplace(Entry.Key, true);
+            for (int32 c = Children[Entry.Key].Num() - 1; c >= 0; --c)
+            {
+                Stack.Emplace(Children[Entry.Key][c], false);
+            }
+        }
+
+        FNifTypeIndex::Intervals = MoveTemp(Numbered);
+        UE_LOG(LogTemp, Verbose, TEXT("[NIF] Type index: %d types numbered (%d roots)"), Next, Roots.Num());
+    }
+}
+
+namespace FNifTypeIndex
+{
+    TArray<FInterval> Intervals;
+
+    void Register(const Type& BlockType)
+    {
+        if (GTypeIndexDisabled) return;
+
+        // The type and the bases above it (up to RefObject) that are not in yet
+        bool bAdded = false;
+        for (const Type* T = &BlockType; T; T = T->base_type)
+        {
+            const int32 Number = T->internal_type_number;
+            if (Number < 0 || Number > 0xFFFF)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF] Type number %d out of range; type checks use niflib's walk."), Number);
+                GTypeIndexDisabled = true;
+                Intervals.Empty();
+                return;
+            }
+            if (Number >= GKnownTypes.Num()) GKnownTypes.SetNumZeroed(Number + 1);
+            if (GKnownTypes[Number] == T) break;   // this type and its bases are in already
+            if (GKnownTypes[Number])
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF] Type number %d is shared; type checks use niflib's walk."), Number);
+                GTypeIndexDisabled = true;
+                Intervals.Empty();
+                return;
+            }
+            GKnownTypes[Number] = T;
+            bAdded = true;
+        }
+
+        if (bAdded)
+        {
+            Renumber();
+        }
+    }
+}
@@ -0,0 +1,206 @@
+#include "NifVertexKernels.h"
+#include "NifCore.h"
+#include "Math/VectorRegister.h"
+#include "Math/RandomStream.h"
+#include "HAL/IConsoleManager.h"
+
+FNifStreamTransform FNifStreamTransform::Make(const FTransform& WorldXf)
+{
+    // NIF and UE are both Z-up and ToUE is component-wise, so the basis change is identity here and the
+    // handedness change lives entirely in the triangle winding
+    FNifStreamTransform Out;
+    const FMatrix WorldMatrix = WorldXf.ToMatrixWithScale();
+    Out.PositionMatrix = FMatrix44f(WorldMatrix);
+    Out.DirectionMatrix = FMatrix44f(WorldXf.ToMatrixNoScale().RemoveTranslation());
+    Out.bFlipWinding = WorldMatrix.Determinant() >= 0.0;
+    return Out;
+}
+
+namespace
+{
+    // Per component: x - x is 0 for finite x and NaN for NaN/Inf, so the compare is a finite mask
+    static FORCEINLINE VectorRegister4Float SanitizeFinite(const VectorRegister4Float V)
+    {
+        const VectorRegister4Float Zero = VectorZeroFloat();
+        return VectorSelect(VectorCompareEQ(VectorSubtract(V, V), Zero), V, Zero);
+    }
+
+    // Row-vector transform: x*R0 + y*R1 + z*R2 (+ R3 for points)
+    static FORCEINLINE VectorRegister4Float TransformXYZ(const VectorRegister4Float V, const VectorRegister4Float R0, const VectorRegister4Float R1, const VectorRegister4Float R2)
+    {
+        VectorRegister4Float Result = VectorMultiply(VectorReplicate(V, 0), R0);
+        Result = VectorMultiplyAdd(VectorReplicate(V, 1), R1, Result);
+        return VectorMultiplyAdd(VectorReplicate(V, 2), R2, Result);
+    }
+}
+
+namespace FNifVertexKernels
+{
+    void TransformPositions(const FNifStreamTransform& Xf, const float* InXYZ, int32 Num, FVector3f* Out)
+    {
+        const VectorRegister4Float R0 = VectorLoad(&Xf.PositionMatrix.M[0][0]);
+        const VectorRegister4Float R1 = VectorLoad(&Xf.PositionMatrix.M[1][0]);
+        const VectorRegister4Float R2 = VectorLoad(&Xf.PositionMatrix.M[2][0]);
+        const VectorRegister4Float R3 = VectorLoad(&Xf.PositionMatrix.M[3][0]);
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const VectorRegister4Float P = SanitizeFinite(VectorLoadFloat3(InXYZ + i * 3));
+            VectorStoreFloat3(VectorAdd(TransformXYZ(P, R0, R1, R2), R3), &Out[i].X);
+        }
+    }
+
+    void TransformDirections(const FNifStreamTransform& Xf, const float* InXYZ, int32 Num, FVector3f* Out)
+    {
+        const VectorRegister4Float R0 = VectorLoad(&Xf.DirectionMatrix.M[0][0]);
+        const VectorRegister4Float R1 = VectorLoad(&Xf.DirectionMatrix.M[1][0]);
+        const VectorRegister4Float R2 = VectorLoad(&Xf.DirectionMatrix.M[2][0]);
+        const VectorRegister4Float Zero = VectorZeroFloat();
+        const VectorRegister4Float MinLengthSq = VectorSetFloat1(UE_SMALL_NUMBER);
+
+        for (int32 i = 0; i < Num; ++i)
+        {
+            const VectorRegister4Float D = TransformXYZ(SanitizeFinite(VectorLoadFloat3(InXYZ + i * 3)), R0, R1, R2);
+
+            // rsqrt of a (near) zero length is Inf; the mask picks zero for those instead
+            const VectorRegister4Float LengthSq = VectorDot3(D, D);
+            const VectorRegister4Float Normalized = VectorMultiply(D, VectorReciprocalSqrtAccurate(LengthSq));
+            VectorStoreFloat3(VectorSelect(VectorCompareGT(LengthSq, MinLengthSq), Normalized, Zero), &Out[i].X);
+        }
+    }
+
+    // Face and influence kernels have no SIMD-specific part; the engine-agnostic core owns them
+
+    void ConvertTriangles(const FNifStreamTransform& Xf, const uint16* InTris, int32 NumTris, uint32 BaseVertex, uint32* Out)
+    {
+        NifCore::ConvertTriangles(Xf.bFlipWinding, InTris, NumTris, BaseVertex, Out);
+    }
+
+    int32 CountStripTriangles(const uint16* Strip, int32 Len)
+    {
+        return NifCore::CountStripTriangles(Strip, Len);
+    }
+
+    int32 ConvertStrip(const FNifStreamTransform& Xf, const uint16* Strip, int32 Len, uint32 BaseVertex, uint32* Out)
+    {
+        return NifCore::ConvertStrip(Xf.bFlipWinding, Strip, Len, BaseVertex, Out);
+    }
+
+    int32 NormalizeInfluences(int32* Bones, float* Weights, int32 NumVerts, int32 K, int32 NumBones, int32 FallbackBone)
+    {
+        static_assert(NifCore::NoBone == INDEX_NONE, "packed rows share the empty-slot marker");
+        return NifCore::NormalizeInfluences(Bones, Weights, NumVerts, K, NumBones, FallbackBone);
+    }
+
+    int32 CountInfluences(const int32* Bones, int32 NumVerts, int32 K, int32 NumBones)
+    {
+        return NifCore::CountInfluences(Bones, NumVerts, K, NumBones);
+    }
+}
+
+// Nif.BenchVertexKernels [NumVerts] [Iterations]: the per-vertex double FTransform path and the per-triangle
+// strip expansion vs the stream kernels
+static FAutoConsoleCommand GNifBenchVertexKernelsCommand(
+    TEXT("Nif.BenchVertexKernels"),
+    TEXT("Time the scalar vertex transform and strip expansion paths against the stream kernels. Usage: Nif.BenchVertexKernels [NumVerts] [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        const int32 NumVerts = FMath::Max(1, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000000);
+        const int32 Iterations = FMath::Max(1, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 20);
+
+        FRandomStream Rng(0x4E4946);
+        TArray<FVector3f> InPos, InNrm;
+        InPos.SetNumUninitialized(NumVerts);
+        InNrm.SetNumUninitialized(NumVerts);
+        for (int32 i = 0; i < NumVerts; ++i)
+        {
+            InPos[i] = FVector3f(Rng.FRandRange(-100.f, 100.f), Rng.FRandRange(-100.f, 100.f), Rng.FRandRange(-100.f, 100.f));
+            InNrm[i] = FVector3f(Rng.GetUnitVector());
+        }
+
+        const FTransform WorldXf(FRotator(30.0, 45.0, 60.0), FVector(12.0, -3.0, 7.5), FVector(1.5));
+        const FNifStreamTransform StreamXf = FNifStreamTransform::Make(WorldXf);
+
+        TArray<FVector3f> ScalarPos, ScalarNrm, KernelPos, KernelNrm;
+        ScalarPos.SetNumUninitialized(NumVerts);
+        ScalarNrm.SetNumUninitialized(NumVerts);
+        KernelPos.SetNumUninitialized(NumVerts);
+        KernelNrm.SetNumUninitialized(NumVerts);
+
+        const uint64 ScalarStartCycles = FPlatformTime::Cycles64();
+        for (int32 It = 0; It < Iterations; ++It)
+        {
+            for (int32 i = 0; i < NumVerts; ++i)
+            {
+                ScalarPos[i] = (FVector3f)WorldXf.TransformPosition(FVector(InPos[i]));
+                ScalarNrm[i] = (FVector3f)WorldXf.TransformVectorNoScale(FVector(InNrm[i])).GetSafeNormal();
+            }
+        }
+        const double ScalarMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ScalarStartCycles) / Iterations;
+
+        const uint64 KernelStartCycles = FPlatformTime::Cycles64();
+        for (int32 It = 0; It < Iterations; ++It)
+        {
+            FNifVertexKernels::TransformPositions(StreamXf, &InPos[0].X, NumVerts, KernelPos.GetData());
+            FNifVertexKernels::TransformDirections(StreamXf, &InNrm[0].X, NumVerts, KernelNrm.GetData());
+        }
+        const double KernelMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - KernelStartCycles) / Iterations;
+
+        float MaxPosError = 0.f, MaxNrmError = 0.f;
+        for (int32 i = 0; i < NumVerts; ++i)
+        {
+            MaxPosError = FMath::Max(MaxPosError, (ScalarPos[i] - KernelPos[i]).GetAbsMax());
+            MaxNrmError = FMath::Max(MaxNrmError, (ScalarNrm[i] - KernelNrm[i]).GetAbsMax());
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Vertex kernels, %d verts x %d: Scalar=%.3f ms Kernel=%.3f ms (%.2fx, %.1f Mverts/s) MaxErr pos=%g nrm=%g"),
+            NumVerts, Iterations, ScalarMs, KernelMs, ScalarMs / FMath::Max(KernelMs, 1e-6),
+            NumVerts / FMath::Max(KernelMs * 1000.0, 1e-6), MaxPosError, MaxNrmError);
+
+        // Strips: a grid-like strip over the same vertex count, restarted with degenerates every 64 indices
+        TArray<uint16> Strip;
+        Strip.Reserve(NumVerts + NumVerts / 32);
+        for (int32 i = 0; i < NumVerts; ++i)
+        {
+            Strip.Add((uint16)(i & 0xFFFF));
+            if ((i & 63) == 63)
+            {
+                Strip.Add((uint16)(i & 0xFFFF));
+                Strip.Add((uint16)((i + 1) & 0xFFFF));
+            }
+        }
+
+        // Reference: list of (a, b, c) structs first, then pushed one index at a time with the winding swapped
+        TArray<uint32> ScalarIdx;
+        const uint64 ScalarStripStartCycles = FPlatformTime::Cycles64();
+        for (int32 It = 0; It < Iterations; ++It)
+        {
+            TArray<FIntVector> Tris;
+            for (int32 i = 2; i < Strip.Num(); ++i)
+            {
+                const int32 A = Strip[i - 2], B = Strip[i - 1], C = Strip[i];
+                if (A == B || B == C || A == C) continue;
+                Tris.Add((i & 1) ? FIntVector(A, C, B) : FIntVector(A, B, C));
+            }
+            ScalarIdx.Reset();
+            for (const FIntVector& T : Tris)
+            {
+                ScalarIdx.Add(T.X); ScalarIdx.Add(T.Z); ScalarIdx.Add(T.Y);
+            }
+        }
+        const double ScalarStripMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ScalarStripStartCycles) / Iterations;
+
+        TArray<uint32> KernelIdx;
+        const FNifStreamTransform Unmirrored;
+        const uint64 KernelStripStartCycles = FPlatformTime::Cycles64();
+        for (int32 It = 0; It < Iterations; ++It)
+        {
+            KernelIdx.SetNumUninitialized(FNifVertexKernels::CountStripTriangles(Strip.GetData(), Strip.Num()) * 3);
+            FNifVertexKernels::ConvertStrip(Unmirrored, Strip.GetData(), Strip.Num(), 0, KernelIdx.GetData());
+        }
+        const double KernelStripMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - KernelStripStartCycles) / Iterations;
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Strip kernel, %d indices x %d: Scalar=%.3f ms Kernel=%.3f ms (%.2fx) Match=%s"),
+            Strip.Num(), Iterations, ScalarStripMs, KernelStripMs, ScalarStripMs / FMath::Max(KernelStripMs, 1e-6),
+            ScalarIdx == KernelIdx ? TEXT("yes") : TEXT("NO"));
+    }));
@@ -0,0 +1,2037 @@
+#include "NiflibBridge.h"
+#include "NifReader.h"
+#include "NifMeshCache.h"
+#include "NifVertexKernels.h"
+#include "NifCore.h"
+#include "NifCoreScene.h"
+#include "NifTypeIndex.h"
+#include "Logging/LogMacros.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "GPUSkinPublicDefs.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Misc/ScopeLock.h"
+
+// --- Niflib headers ---
+#include <niflib.h>
+#include <obj/NiObject.h>
+#include <obj/NiNode.h>
+#include <obj/NiAVObject.h>
+#include <obj/NiGeometry.h>
+#include <obj/NiGeometryData.h>
+#include <obj/NiTriShape.h>
+#include <obj/NiTriShapeData.h>
+#include <obj/NiTriStrips.h>
+#include <obj/NiTriStripsData.h>
+#include <gen/enums.h>
+#include <obj/NiSkinInstance.h>
+#include <obj/NiSkinData.h>
+#include <obj/NiSkinPartition.h>
+#include <obj/NiControllerSequence.h>
+#include <obj/NiKeyframeController.h>
+#include <obj/NiKeyframeData.h>
+#include <obj/NiBSplineData.h>
+#include <obj/NiInterpolator.h>
+#include <obj/NiTransformInterpolator.h>
+#include <obj/NiBSplineTransformInterpolator.h>
+#include <obj/NiStringPalette.h>
+#include <gen/ControllerLink.h>
+#include <kfm.h>
+
+#include <atomic>
+
+using namespace Niflib;
+
+namespace
+{
+    // --------- toggles ---------
+    static constexpr bool bCreateStubBonesForUnmappedSkinBones = true;
+    static constexpr bool bUseMappedReader = true;      // false = niflib's own std::ifstream path (for A/B timing)
+    static constexpr bool bUseMeshCache = true;         // Intermediate/NifCache; false = always run niflib
+    static constexpr bool bParallelGeometryExtraction = true;  // false = fill geometries one after another (same output)
+    static constexpr bool bReleaseConsumedNifData = true;      // streaming scenes free niflib geometry once emitted; false = keep (same output)
+    static constexpr bool bLazyBlockDecoding = true;    // mapped reader: geometry, skin and key data decode when first needed; false = all on open (same output)
+    static constexpr float DefaultAnimSampleRate = 30.f;  // legacy single-clip API (ParseNifFile*)
+
+    // --------- small helpers ---------
+    // The stream kernels read niflib's arrays in place as packed floats / uint16 triples
+    static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 must be packed xyz floats");
+    static_assert(sizeof(Triangle) == 3 * sizeof(uint16), "Triangle must be three packed uint16 indices");
+
+    static FORCEINLINE FVector3f ToUE(const Vector3& v)
+    {
+        return FVector3f((float)v.x, (float)v.y, (float)v.z);
+    }
+    static FORCEINLINE FVector2f ToUE_NoFlipV(const TexCoord& uv)
+    {
+        return FVector2f((float)uv.u, (float)uv.v);
+    }
+    static FORCEINLINE FVector2f ToUE_FlipV(const TexCoord& uv)
+    {
+        const float u = FMath::IsFinite((float)uv.u) ? (float)uv.u : 0.0f;
+        const float v = FMath::IsFinite((float)uv.v) ? (float)uv.v : 0.0f;
+        return FVector2f(u, 1.0f - v);
+    }
+
+    static FTransform LocalToFTransform(const NiAVObjectRef& Obj)
+    {
+        const Vector3 T = Obj->GetLocalTranslation();
+        const Matrix33 R = Obj->GetLocalRotation();
+        const float S = Obj->GetLocalScale();
+
+        FMatrix Rot(
+            FPlane((float)R[0][0], (float)R[0][1], (float)R[0][2], 0.f),
+            FPlane((float)R[1][0], (float)R[1][1], (float)R[1][2], 0.f),
+            FPlane((float)R[2][0], (float)R[2][1], (float)R[2][2], 0.f),
+            FPlane((float)T.x, (float)T.y, (float)T.z, 1.f)
+        );
+        FTransform Xf(Rot);
+        if (!FMath::IsNearlyEqual(S, 1.f))
+        {
+            Xf.SetScale3D(FVector(S));
+        }
+        return Xf;
+    }
+
+    static FString CanonName(const FString& In)
+    {
+        FString S = In;
+        if (S.StartsWith(TEXT("Game_"), ESearchCase::CaseSensitive))
+        {
+            S.RightChopInline(5, false);
+        }
+        return S;
+    }
+
+    // ---------- scene index ----------
+    // NifCore's scene walk (names, LOD buckets, skins, material names) plus what only the UE side needs per node:
+    // names as FStrings and local / world FTransforms, composed once per node
+    struct FNifSceneIndex
+    {
+        NifCore::FSceneIndex Core;
+        TArray<FString> Names;                  // Core.Names as authored, by id
+        TArray<FTransform> Local;               // by node
+        TArray<FTransform> World;               // by node
+        TSet<int32> ReselectedGeometries;       // streaming: picked by more than one LOD index (clamped requests), never freed early
+    };
+
+    // ---------- traversal context ----------
+    struct FTraversalCtx
+    {
+        FNifMeshStreams& Mesh;
+        const FNifSceneIndex& Index;
+
+        TMap<const void*, int32> NodeToBoneIndex;
+        TMap<int32, int32> NameToBoneIndex;     // key id and canon id of each bone's name -> bone
+        NifCore::FMaterialTable Materials;      // slots of Mesh.Materials, filled in once every geometry is planned
+        TSet<const void*> VisitedGeoData;
+
+        bool bBonesBuilt = false;
+        bool bReleaseConsumed = false;          // streaming scene: free niflib data nothing else references once emitted
+
+        int32 RequestedLOD = -1;
+        int32 PrimaryRootIndex = INDEX_NONE;
+    };
+
+    static int32 EnsureBoneForNode(const NiAVObjectRef& Node, FTraversalCtx& Ctx)
+    {
+        if (!Node) return INDEX_NONE;
+
+        const void* Key = Node.operator->();
+        if (int32* Found = Ctx.NodeToBoneIndex.Find(Key))
+        {
+            return *Found;
+        }
+
+        // Parent and local pose come from the scene index; nodes outside the graph fall back to niflib
+        const NifCore::FSceneIndex& Scene = Ctx.Index.Core;
+        const int32 NodeIdx = Scene.Find(Node);
+        const NiAVObjectRef ParentAV = (NodeIdx != INDEX_NONE)
+            ? (Scene.Nodes[NodeIdx].Parent != INDEX_NONE ? NiAVObjectRef(Scene.Nodes[Scene.Nodes[NodeIdx].Parent].Obj) : NiAVObjectRef())
+            : DynamicCast<NiAVObject>(Node->GetParent());
+
+        int32 ParentIdx = INDEX_NONE;
+        if (ParentAV)
+        {
+            ParentIdx = EnsureBoneForNode(ParentAV, Ctx);
+        }
+        else
+        {
+            if (Ctx.PrimaryRootIndex != INDEX_NONE)
+            {
+                ParentIdx = Ctx.PrimaryRootIndex;
+            }
+        }
+
+        const NifCore::FNameTable& Names = Scene.Names;
+        const int32 NameId = (NodeIdx != INDEX_NONE) ? Scene.Nodes[NodeIdx].NameId : Names.Find(Node->GetName());
+        FString BoneName = (NameId != INDEX_NONE) ? Ctx.Index.Names[NameId] : FString(UTF8_TO_TCHAR(Node->GetName().c_str()));
+        if (BoneName.IsEmpty())
+        {
+            BoneName = TEXT("Bone");
+        }
+
+        FNifBone UEbone;
+        UEbone.Name = BoneName;
+        UEbone.ParentIndex = ParentIdx;
+        UEbone.BindPose = (NodeIdx != INDEX_NONE) ? Ctx.Index.Local[NodeIdx] : LocalToFTransform(Node);
+
+        const int32 NewIdx = Ctx.Mesh.Bones.Add(UEbone);
+
+        if (ParentIdx == INDEX_NONE && Ctx.PrimaryRootIndex == INDEX_NONE)
+        {
+            Ctx.PrimaryRootIndex = NewIdx;
+        }
+
+        Ctx.NodeToBoneIndex.Add(Key, NewIdx);
+        if (NameId != INDEX_NONE)
+        {
+            Ctx.NameToBoneIndex.FindOrAdd(Names.KeyIds[NameId], NewIdx);
+            Ctx.NameToBoneIndex.FindOrAdd(Names.CanonIds[NameId], NewIdx);
+        }
+        return NewIdx;
+    }
+
+    static int32 EnsureStubBoneByName(int32 NameId, FTraversalCtx& Ctx)
+    {
+        const NifCore::FNameTable& Names = Ctx.Index.Core.Names;
+        const int32 CanonId = Names.CanonIds[NameId];
+
+        if (int32* FoundCanon = Ctx.NameToBoneIndex.Find(CanonId))
+        {
+            return *FoundCanon;
+        }
+        if (int32* FoundExact = Ctx.NameToBoneIndex.Find(Names.KeyIds[NameId]))
+        {
+            return *FoundExact;
+        }
+
+        FNifBone UEbone;
+        UEbone.Name = Ctx.Index.Names[NameId];
+        UEbone.ParentIndex = (Ctx.PrimaryRootIndex != INDEX_NONE) ? Ctx.PrimaryRootIndex : INDEX_NONE;
+        UEbone.BindPose = FTransform::Identity;
+
+        const int32 NewIdx = Ctx.Mesh.Bones.Add(UEbone);
+        if (UEbone.ParentIndex == INDEX_NONE && Ctx.PrimaryRootIndex == INDEX_NONE)
+        {
+            Ctx.PrimaryRootIndex = NewIdx;
+        }
+
+        Ctx.NameToBoneIndex.FindOrAdd(Names.KeyIds[NameId], NewIdx);
+        Ctx.NameToBoneIndex.FindOrAdd(CanonId, NewIdx);
+        return NewIdx;
+    }
+
+    static void BuildBonesFromSkin(const NifCore::FSceneSkin& Skin, FTraversalCtx& Ctx)
+    {
+        if (Skin.BoneNodes.empty())
+        {
+            return;
+        }
+
+        if (Skin.SkeletonRoot != INDEX_NONE)
+        {
+            EnsureBoneForNode(Ctx.Index.Core.Nodes[Skin.SkeletonRoot].Obj, Ctx);
+        }
+        else if (NiNodeRef SkelRoot = Skin.Instance->GetSkeletonRoot())
+        {
+            EnsureBoneForNode(NifCast<NiAVObject>(SkelRoot), Ctx);
+        }
+
+        for (int32 b = 0; b < (int32)Skin.BoneNodes.size(); ++b)
+        {
+            if (Skin.Bones[b] != INDEX_NONE)
+            {
+                EnsureBoneForNode(Ctx.Index.Core.Nodes[Skin.Bones[b]].Obj, Ctx);
+            }
+            else if (Skin.BoneNodes[b])
+            {
+                EnsureBoneForNode(NifCast<NiAVObject>(Skin.BoneNodes[b]), Ctx);
+            }
+        }
+
+        Ctx.bBonesBuilt = true;
+    }
+
+    // Face counts off the stored arrays: degenerates are skipped as GetTriangles() does, without building the list
+    static int32 CountShapeTriangles(const NiTriShapeData* TriData)
+    {
+        int32 Count = 0;
+        for (const Triangle& T : TriData->GetTrianglesView())
+        {
+            Count += (T.v1 != T.v2 && T.v2 != T.v3 && T.v1 != T.v3) ? 1 : 0;
+        }
+        return Count;
+    }
+
+    static int32 CountStripsTriangles(const NiTriStripsData* StripsData)
+    {
+        int32 Count = 0;
+        for (const std::vector<unsigned short>& Strip : StripsData->GetStripsView())
+        {
+            Count += FNifVertexKernels::CountStripTriangles(Strip.data(), (int32)Strip.size());
+        }
+        return Count;
+    }
+
+    static int32 GetTriangleCount(const NiAVObjectRef& Obj)
+    {
+        if (!Obj) return 0;
+        NiGeometry* Geo = NifCast<NiGeometry>(Obj);
+        if (!Geo) return 0;
+
+        NiGeometryDataRef GeoData = Geo->GetData();
+        if (!GeoData) return 0;
+
+        if (NifCast<NiTriShape>(Obj))
+        {
+            if (NiTriShapeData* TriData = NifCast<NiTriShapeData>(GeoData))
+            {
+                return CountShapeTriangles(TriData);
+            }
+        }
+        else if (NifCast<NiTriStrips>(Obj))
+        {
+            if (NiTriStripsData* StripsData = NifCast<NiTriStripsData>(GeoData))
+            {
+                return CountStripsTriangles(StripsData);
+            }
+        }
+        return 0;
+    }
+
+    // ---------- per-geometry vertex streams ----------
+    // Views into NiGeometryData's own arrays (its Get* accessors return copies); valid until ReleaseVertexData.
+    struct FGeoStreams
+    {
+        const std::vector<Vector3>& Vertices;
+        const std::vector<Vector3>& Normals;
+        const std::vector<Vector3>& Tangents;
+        const std::vector<Vector3>& Bitangents;
+        const std::vector<Color4>& Colors;
+        const std::vector<std::vector<TexCoord>>& UVSets;
+
+        explicit FGeoStreams(const NiGeometryData* GeoData)
+            : Vertices(GeoData->GetVerticesView())
+            , Normals(GeoData->GetNormalsView())
+            , Tangents(GeoData->GetTangentsView())
+            , Bitangents(GeoData->GetBitangentsView())
+            , Colors(GeoData->GetColorsView())
+            , UVSets(GeoData->GetUVSetsView())
+        {
+        }
+    };
+
+    // ---------- variant selection helpers ----------
+    struct FGeoCand
+    {
+        NiGeometryRef Geo;
+        FTransform    WorldXf;
+        FString       Name;
+    };
+
+    // One selected geometry: sized, skin-bound and given a material serially, then filled on a worker
+    struct FGeoJob
+    {
+        int32 NodeIdx = INDEX_NONE;
+        FString Name;
+
+        // Raw pointers: niflib's refcount is not atomic, so workers never copy Refs. The scene keeps both alive.
+        const NiGeometryData* Data = nullptr;
+        const NiSkinData* SkinData = nullptr;
+        TArray<int32> SkinBoneMap;              // UE bone per NiSkinInstance bone, INDEX_NONE if unmapped
+        NiGeometryData* ReleaseData = nullptr;  // streaming: freed by the worker once its streams and faces are emitted
+        NiSkinData* ReleaseSkin = nullptr;      // streaming: freed by the worker once its weights are read
+
+        // Face lists are read in place from the niflib data; only a list with degenerates is copied (filtered)
+        const Triangle* Tris = nullptr;                                    // NiTriShape, NumFaces entries
+        const std::vector<std::vector<unsigned short>>* Strips = nullptr;  // NiTriStrips, expanded by the fill
+        std::vector<Triangle> FilteredTris;                                // backs Tris when the stored list has degenerates
+        int32 NumFaces = 0;                     // after degenerate culling
+        FNifStreamTransform StreamXf;
+        int32 NumVerts = 0;
+        int32 MatIndex = 0;
+        int32 VertexBase = 0;                   // prefix sums over the selected geometries
+        int32 FaceBase = 0;
+
+        // Skin binding counters (serial) and fill results (worker), logged afterwards in geometry order
+        int32 MissedBoneMapPtr = 0;
+        int32 MissedNameOrCanon = 0;
+        int32 TotalCollectedWeights = 0;
+        int32 ZeroInfluenceVertsPreFallback = 0;
+        int32 NumBonesUsed = 0;
+        int32 DroppedInfluences = 0;
+        int32 NumUVSets = 0;
+        FString UVSetSizes;
+        double ExtractMs = 0.0;
+    };
+
+    // Serial half: everything that grows shared state (bones, stub bones, materials) or touches Refs
+    static bool PlanGeometry(int32 NodeIdx, FTraversalCtx& Ctx, FGeoJob& Job)
+    {
+        const NifCore::FSceneNode& Node = Ctx.Index.Core.Nodes[NodeIdx];
+        NiGeometry* Geo = Node.Geo;
+        if (!Geo) return false;
+
+        NiGeometryDataRef GeoData = Geo->GetData();
+        if (!GeoData) return false;
+
+        // Quick duplicate-data guard
+        const void* DataKey = GeoData.operator->();
+        if (Ctx.VisitedGeoData.Contains(DataKey))
+        {
+            UE_LOG(LogTemp, Verbose, TEXT("[NIF] Skipping duplicate geometry data: %s"),
+                *Ctx.Index.Names[Node.NameId]);
+            return false;
+        }
+        Ctx.VisitedGeoData.Add(DataKey);
+
+        const NifCore::FNameTable& Names = Ctx.Index.Core.Names;
+        Job.NodeIdx = NodeIdx;
+        Job.Name = Ctx.Index.Names[Node.NameId];
+        Job.Data = GeoData;
+        Job.NumVerts = GeoData->GetVertexCount();
+        Job.StreamXf = FNifStreamTransform::Make(Ctx.Index.World[NodeIdx]);
+        if (Job.NumVerts <= 0) return false;
+
+        // Skin
+        const NifCore::FSceneSkin* Skin = (Node.Skin != INDEX_NONE) ? &Ctx.Index.Core.Skins[Node.Skin] : nullptr;
+        NiSkinDataRef SkinData = Skin ? Skin->Instance->GetSkinData() : NiSkinDataRef();
+
+        if (Skin && !Ctx.bBonesBuilt)
+        {
+            BuildBonesFromSkin(*Skin, Ctx);
+        }
+
+        if (Skin && SkinData && (Ctx.NodeToBoneIndex.Num() > 0 || Ctx.NameToBoneIndex.Num() > 0))
+        {
+            const std::vector<NiNode*>& BoneNodes = Skin->BoneNodes;
+            TArray<FString> UnmappedNames;
+
+            Job.SkinData = SkinData;
+            Job.SkinBoneMap.Init(INDEX_NONE, (int32)BoneNodes.size());
+            for (unsigned int boneIdx = 0; boneIdx < BoneNodes.size(); ++boneIdx)
+            {
+                const NiNode* BoneNode = BoneNodes[boneIdx];
+                if (!BoneNode) continue;
+
+                const void* Key = BoneNode;
+                int32 UEBoneIndex = INDEX_NONE;
+                if (int32* FoundByPtr = Ctx.NodeToBoneIndex.Find(Key))
+                {
+                    UEBoneIndex = *FoundByPtr;
+                }
+                else
+                {
+                    ++Job.MissedBoneMapPtr;
+                    const int32 BoneNameId = Skin->BoneNameIds[boneIdx];
+
+                    if (int32* FoundByName = Ctx.NameToBoneIndex.Find(Names.KeyIds[BoneNameId]))
+                    {
+                        UEBoneIndex = *FoundByName;
+                    }
+                    else if (int32* FoundByCanon = Ctx.NameToBoneIndex.Find(Names.CanonIds[BoneNameId]))
+                    {
+                        UEBoneIndex = *FoundByCanon;
+                    }
+                    else
+                    {
+                        ++Job.MissedNameOrCanon;
+                        UnmappedNames.AddUnique(Ctx.Index.Names[BoneNameId]);
+
+                        if (bCreateStubBonesForUnmappedSkinBones)
+                        {
+                            UEBoneIndex = EnsureStubBoneByName(BoneNameId, Ctx);
+                        }
+                    }
+                }
+                Job.SkinBoneMap[boneIdx] = UEBoneIndex;
+            }
+
+            if (UnmappedNames.Num() > 0 && !bCreateStubBonesForUnmappedSkinBones)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF][Skin] Unmapped skin bones on Geo='%s': %s"),
+                    *Job.Name, *FString::Join(UnmappedNames, TEXT(", ")));
+            }
+        }
+        else if (Skin && !SkinData)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF][Skin] Geo='%s' has NiSkinInstance but no NiSkinData."), *Job.Name);
+        }
+
+        // Triangle list (also sizes the face range)
+        if (NifCast<NiTriShape>(Geo))
+        {
+            if (const NiTriShapeData* TriData = NifCast<NiTriShapeData>(GeoData))
+            {
+                const std::vector<Triangle>& Stored = TriData->GetTrianglesView();
+                Job.NumFaces = CountShapeTriangles(TriData);
+                if (Job.NumFaces == (int32)Stored.size())
+                {
+                    Job.Tris = Stored.data();
+                }
+                else
+                {
+                    // Drop degenerates as GetTriangles() would, so NumFaces matches what the fill writes
+                    Job.FilteredTris.reserve(Job.NumFaces);
+                    for (const Triangle& T : Stored)
+                    {
+                        if (T.v1 != T.v2 && T.v2 != T.v3 && T.v1 != T.v3) Job.FilteredTris.push_back(T);
+                    }
+                    Job.Tris = Job.FilteredTris.data();
+                }
+            }
+        }
+        else if (NifCast<NiTriStrips>(Geo))
+        {
+            // Raw strips instead of GetTriangles(): the fill expands them straight into the face buffer
+            if (const NiTriStripsData* StripsData = NifCast<NiTriStripsData>(GeoData))
+            {
+                Job.Strips = &StripsData->GetStripsView();
+                Job.NumFaces = CountStripsTriangles(StripsData);
+            }
+        }
+        if (Job.NumFaces == 0) return false;
+
+        // Streaming: data no other geometry node references goes as soon as it is consumed. The worker reads
+        // vertex streams, faces and weights in place, so it frees them itself once they are emitted.
+        const bool bOwnedByThisLOD = Ctx.bReleaseConsumed && !Ctx.Index.ReselectedGeometries.Contains(NodeIdx);
+        if (bOwnedByThisLOD && Ctx.Index.Core.NumUses(GeoData) == 1)
+        {
+            Job.ReleaseData = GeoData;
+        }
+        if (bOwnedByThisLOD && Job.SkinData && Ctx.Index.Core.NumUses(Job.SkinData) == 1)
+        {
+            Job.ReleaseSkin = SkinData;
+        }
+
+        // Material slot (Mesh.Materials is filled from Ctx.Materials once every geometry is planned)
+        std::string ConflictPath;
+        Job.MatIndex = Ctx.Materials.Gather(Ctx.Index.Core, NodeIdx, ConflictPath);
+        if (!ConflictPath.empty())
+        {
+            const NifCore::FMaterialSlot& Slot = Ctx.Materials.Slots[Job.MatIndex];
+            UE_LOG(LogTemp, Warning,
+                TEXT("[NIF] Material '%s' appears with different diffuse textures: '%s' vs '%s'"),
+                *Ctx.Index.Names[Slot.NameId], UTF8_TO_TCHAR(Slot.DiffuseTexturePath.c_str()), UTF8_TO_TCHAR(ConflictPath.c_str()));
+        }
+
+        return true;
+    }
+
+    // Worker half: writes only [VertexBase, VertexBase + NumVerts) and [FaceBase, FaceBase + NumFaces) of Mesh
+    static void FillGeometry(FGeoJob& Job, int32 FallbackBone, int32 NumBones, FNifMeshStreams& Mesh)
+    {
+        const uint64 ExtractStartCycles = FPlatformTime::Cycles64();
+
+        const FGeoStreams Streams(Job.Data);
+
+        const int32 NumVerts = Job.NumVerts;
+        const int32 Base = Job.VertexBase;
+        const int32 K = Mesh.MaxInfluences;
+
+        // UV sets (for logging)
+        const int UVSetCount = (int)Streams.UVSets.size();
+        const std::vector<std::vector<TexCoord>>& UVSets = Streams.UVSets;
+        Job.NumUVSets = UVSetCount;
+        for (int setIdx = 0; setIdx < UVSetCount; ++setIdx)
+        {
+            Job.UVSetSizes += (setIdx == 0 ? TEXT("") : TEXT(", "));
+            Job.UVSetSizes += FString::Printf(TEXT("%d:%d"), setIdx, (int32)UVSets[setIdx].size());
+        }
+
+        // Packed skin slots for this geometry's vertex range
+        int32* SlotBones = Mesh.BoneIndices.GetData() + Base * K;
+        float* SlotWeights = Mesh.BoneWeights.GetData() + Base * K;
+        for (int32 s = 0; s < NumVerts * K; ++s)
+        {
+            SlotBones[s] = INDEX_NONE;
+            SlotWeights[s] = 0.0f;
+        }
+
+        if (Job.SkinData)
+        {
+            // Vertex-major table from NiSkinData in one transpose; each packed row is then filled in one visit
+            std::vector<unsigned int> Offsets;
+            std::vector<unsigned short> EntryBones;
+            std::vector<float> EntryWeights;
+            Job.SkinData->GetVertexWeights((unsigned int)NumVerts, Offsets, EntryBones, EntryWeights);
+            if (Job.ReleaseSkin)
+            {
+                Job.ReleaseSkin->ReleaseVertexWeights();
+            }
+
+            const NifCore::FSkinPackStats SkinStats = NifCore::PackSkinInfluences(Offsets.data(), EntryBones.data(), EntryWeights.data(), NumVerts,
+                Job.SkinBoneMap.GetData(), Job.SkinBoneMap.Num(), NumBones, K, SlotBones, SlotWeights);
+            Job.TotalCollectedWeights = SkinStats.CollectedWeights;
+            Job.ZeroInfluenceVertsPreFallback = SkinStats.ZeroInfluenceVerts;
+            Job.NumBonesUsed = SkinStats.BonesUsed;
+        }
+
+        // Validate, sort and normalize the packed rows; unskinned vertices fall back to the root bone
+        Job.DroppedInfluences = FNifVertexKernels::NormalizeInfluences(SlotBones, SlotWeights, NumVerts, K, NumBones, FallbackBone);
+
+        // Emit vertex streams (linear passes over the prefetched niflib arrays)
+        const int NumPositions = FMath::Min(NumVerts, (int)Streams.Vertices.size());
+        const int NumNormals = FMath::Min(NumVerts, (int)Streams.Normals.size());
+        const int NumUV0 = (UVSetCount > 0) ? FMath::Min(NumVerts, (int)UVSets[0].size()) : 0;
+        const int NumColors = FMath::Min(NumVerts, (int)Streams.Colors.size());
+        const int NumTangents = FMath::Min(NumVerts, FMath::Min((int)Streams.Tangents.size(), (int)Streams.Bitangents.size()));
+
+        FVector3f* OutPos = Mesh.Positions.GetData() + Base;
+        FVector3f* OutNrm = Mesh.Normals.GetData() + Base;
+        FVector2f* OutUV = Mesh.UVs.GetData() + Base;
+        FColor* OutCol = Mesh.Colors.GetData() + Base;
+        FVector3f* OutTan = Mesh.Tangents.GetData() + Base;
+        FVector3f* OutBit = Mesh.Bitangents.GetData() + Base;
+
+        // Positions, normals and tangent frames go through the SIMD stream kernels; the tails past each
+        // source array's length are zeroed
+        if (NumPositions > 0)
+            FNifVertexKernels::TransformPositions(Job.StreamXf, &Streams.Vertices[0].x, NumPositions, OutPos);
+        if (NumNormals > 0)
+            FNifVertexKernels::TransformDirections(Job.StreamXf, &Streams.Normals[0].x, NumNormals, OutNrm);
+        if (NumTangents > 0)
+        {
+            FNifVertexKernels::TransformDirections(Job.StreamXf, &Streams.Tangents[0].x, NumTangents, OutTan);
+            FNifVertexKernels::TransformDirections(Job.StreamXf, &Streams.Bitangents[0].x, NumTangents, OutBit);
+        }
+        for (int i = NumPositions; i < NumVerts; ++i)
+        {
+            OutPos[i] = FVector3f::ZeroVector;
+        }
+        for (int i = NumNormals; i < NumVerts; ++i)
+        {
+            OutNrm[i] = FVector3f::ZeroVector;
+        }
+        for (int i = NumTangents; i < NumVerts; ++i)
+        {
+            OutTan[i] = FVector3f::ZeroVector;
+            OutBit[i] = FVector3f::ZeroVector;
+        }
+
+        for (int i = 0; i < NumVerts; ++i)
+        {
+            OutUV[i] = (i < NumUV0) ? ToUE_NoFlipV(UVSets[0][i]) : FVector2f(0, 0);
+
+            if (i < NumColors)
+            {
+                const Color4& C = Streams.Colors[i];
+                OutCol[i] = FLinearColor(C.r, C.g, C.b, C.a).ToFColor(false);
+            }
+            else
+            {
+                OutCol[i] = FColor::White;
+            }
+        }
+
+        // Emit faces, rebased onto this geometry's vertex range
+        const int32 NumFaces = Job.NumFaces;
+        uint32* OutIdx = reinterpret_cast<uint32*>(Mesh.Indices.GetData() + Job.FaceBase * 3);
+        if (Job.Tris)
+        {
+            FNifVertexKernels::ConvertTriangles(Job.StreamXf, reinterpret_cast<const uint16*>(Job.Tris), NumFaces, (uint32)Base, OutIdx);
+        }
+        else
+        {
+            int32 Written = 0;
+            for (const std::vector<unsigned short>& Strip : *Job.Strips)
+            {
+                Written += FNifVertexKernels::ConvertStrip(Job.StreamXf, Strip.data(), (int32)Strip.size(), (uint32)Base, OutIdx + Written * 3);
+            }
+            check(Written == NumFaces);
+        }
+        int32* OutMat = Mesh.FaceMaterials.GetData() + Job.FaceBase;
+        for (int32 f = 0; f < NumFaces; ++f)
+        {
+            OutMat[f] = Job.MatIndex;
+        }
+        Job.Tris = nullptr;
+        Job.Strips = nullptr;
+        std::vector<Triangle>().swap(Job.FilteredTris);
+
+        // The views above are dead now; owned data can go
+        if (Job.ReleaseData)
+        {
+            Job.ReleaseData->ReleaseVertexData();
+            if (NiTriShapeData* TriData = NifCast<NiTriShapeData>(Job.ReleaseData))
+            {
+                TriData->ReleaseTriangles();
+            }
+            else if (NiTriStripsData* StripsData = NifCast<NiTriStripsData>(Job.ReleaseData))
+            {
+                StripsData->ReleaseStrips();
+            }
+        }
+
+        Job.ExtractMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ExtractStartCycles);
+    }
+
+    // Append the selected geometries (in order) to Ctx.Mesh. Every geometry's vertex and face range is fixed
+    // by a prefix sum before any stream is filled, so the parallel fill is deterministic. Returns the count appended.
+    static int32 ExtractGeometries(const TArray<int32>& GeoNodes, FTraversalCtx& Ctx)
+    {
+        TArray<FGeoJob> Jobs;
+        Jobs.Reserve(GeoNodes.Num());
+        for (int32 NodeIdx : GeoNodes)
+        {
+            if (!PlanGeometry(NodeIdx, Ctx, Jobs.AddDefaulted_GetRef()))
+            {
+                Jobs.Pop(false);
+            }
+        }
+
+        FNifMeshStreams& Mesh = Ctx.Mesh;
+        Mesh.Materials.SetNum((int32)Ctx.Materials.Slots.size());
+        for (int32 i = 0; i < Mesh.Materials.Num(); ++i)
+        {
+            const NifCore::FMaterialSlot& Slot = Ctx.Materials.Slots[i];
+            Mesh.Materials[i].Name = Ctx.Index.Names[Slot.NameId];
+            Mesh.Materials[i].DiffuseTexturePath = UTF8_TO_TCHAR(Slot.DiffuseTexturePath.c_str());
+        }
+
+        int32 NumVerts = Mesh.NumVertices();
+        int32 NumFaces = Mesh.NumFaces();
+        for (FGeoJob& Job : Jobs)
+        {
+            Job.VertexBase = NumVerts;
+            Job.FaceBase = NumFaces;
+            NumVerts += Job.NumVerts;
+            NumFaces += Job.NumFaces;
+        }
+
+        const int32 K = Mesh.MaxInfluences;
+        Mesh.Positions.SetNumUninitialized(NumVerts);
+        Mesh.Normals.SetNumUninitialized(NumVerts);
+        Mesh.UVs.SetNumUninitialized(NumVerts);
+        Mesh.Colors.SetNumUninitialized(NumVerts);
+        Mesh.Tangents.SetNumUninitialized(NumVerts);
+        Mesh.Bitangents.SetNumUninitialized(NumVerts);
+        Mesh.BoneIndices.SetNumUninitialized(NumVerts * K);
+        Mesh.BoneWeights.SetNumUninitialized(NumVerts * K);
+        Mesh.Indices.SetNumUninitialized(NumFaces * 3);
+        Mesh.FaceMaterials.SetNumUninitialized(NumFaces);
+
+        // The bone list is final once every geometry is planned (ExtractLODStreams adds a root bone if it is empty)
+        const int32 FallbackBone = (Ctx.PrimaryRootIndex != INDEX_NONE) ? Ctx.PrimaryRootIndex : 0;
+        const int32 NumBones = FMath::Max(1, Mesh.Bones.Num());
+        const uint64 FillStartCycles = FPlatformTime::Cycles64();
+        ParallelFor(Jobs.Num(), [&Jobs, FallbackBone, NumBones, &Mesh](int32 JobIdx)
+        {
+            LLM_SCOPE_BYNAME(TEXT("Nif/Extract"));   // memory tags do not follow work onto task threads
+            FillGeometry(Jobs[JobIdx], FallbackBone, NumBones, Mesh);
+        }, bParallelGeometryExtraction ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+        const double FillMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - FillStartCycles);
+
+        int32 TotalVerts = 0, TotalFaces = 0;
+        const FGeoJob* Slowest = nullptr;
+        for (const FGeoJob& Job : Jobs)
+        {
+            if (!Job.UVSetSizes.IsEmpty())
+            {
+                UE_LOG(LogTemp, Log, TEXT("[NIF] Geo='%s' UV sets: %d  (sizes: %s)"),
+                    *Job.Name, Job.NumUVSets, *Job.UVSetSizes);
+            }
+            else
+            {
+                UE_LOG(LogTemp, Verbose, TEXT("[NIF] Geo='%s' has no UV sets."), *Job.Name);
+            }
+
+            if (Job.SkinData)
+            {
+                UE_LOG(LogTemp, Log, TEXT("[NIF][Skin] Geo='%s' Verts=%d  TotalWeights=%d  ZeroInfVerts(pre-fallback)=%d  MissPtr=%d  MissNameOrCanon=%d  BonesUsed=%d  Dropped=%d"),
+                    *Job.Name,
+                    Job.NumVerts,
+                    Job.TotalCollectedWeights,
+                    Job.ZeroInfluenceVertsPreFallback,
+                    Job.MissedBoneMapPtr,
+                    Job.MissedNameOrCanon,
+                    Job.NumBonesUsed,
+                    Job.DroppedInfluences);
+            }
+
+            UE_LOG(LogTemp, Verbose, TEXT("[NIF][Perf] Geo='%s' Verts=%d Faces=%d Extract=%.3f ms (%.1f ns/vert)"),
+                *Job.Name, Job.NumVerts, Job.NumFaces, Job.ExtractMs, Job.ExtractMs * 1.0e6 / FMath::Max(1.0, (double)Job.NumVerts));
+
+            TotalVerts += Job.NumVerts;
+            TotalFaces += Job.NumFaces;
+            if (!Slowest || Job.ExtractMs > Slowest->ExtractMs) Slowest = &Job;
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Filled %d geometries (%s, %d verts, %d faces) in %.3f ms; slowest '%s' %.3f ms"),
+            Jobs.Num(), bParallelGeometryExtraction ? TEXT("parallel") : TEXT("serial"), TotalVerts, TotalFaces, FillMs,
+            Slowest ? *Slowest->Name : TEXT("-"), Slowest ? Slowest->ExtractMs : 0.0);
+        return Jobs.Num();
+    }
+
+    // ---------- scene index build / queries ----------
+
+    static bool IsDerivedIndexed(const Niflib::Type& Type, const Niflib::Type& Base)
+    {
+        return FNifTypeIndex::IsDerived(Type, Base);
+    }
+
+    // The walk itself is NifCore's; this adds the FString names and the node transforms (parents precede children in
+    // the pre-order, so one forward pass composes every world transform)
+    static void BuildSceneIndex(const std::vector<NiObjectRef>& Blocks, const std::vector<std::string>& HeaderStrings, FNifSceneIndex& Out)
+    {
+        static_assert(NifCore::NoIndex == INDEX_NONE, "scene indices share the missing-entry marker");
+
+        Out = FNifSceneIndex();
+        NifCore::BuildSceneIndex(Blocks, HeaderStrings, &IsDerivedIndexed, Out.Core);
+
+        Out.Names.Reserve((int32)Out.Core.Names.Names.size());
+        for (const std::string& Name : Out.Core.Names.Names)
+        {
+            Out.Names.Add(UTF8_TO_TCHAR(Name.c_str()));
+        }
+
+        const int32 NumNodes = (int32)Out.Core.Nodes.size();
+        Out.Local.SetNum(NumNodes);
+        Out.World.SetNum(NumNodes);
+        for (int32 i = 0; i < NumNodes; ++i)
+        {
+            const NifCore::FSceneNode& N = Out.Core.Nodes[i];
+            Out.Local[i] = LocalToFTransform(N.Obj);
+            Out.World[i] = (N.Parent != INDEX_NONE) ? Out.Local[i] * Out.World[N.Parent] : Out.Local[i];
+        }
+    }
+
+    // Geometry nodes ExtractLODStreams builds RequestedLOD from (NifCore::SelectLODGeometries), with the reasons logged
+    static bool SelectLODGeometries(const FNifSceneIndex& Index, int32 RequestedLOD, bool bLog, TArray<int32>& OutGeoNodes)
+    {
+        OutGeoNodes.Reset();
+        const NifCore::FSceneIndex& Scene = Index.Core;
+
+        NifCore::FLODSelection Selection;
+        const bool bSelected = NifCore::SelectLODGeometries(Scene, RequestedLOD, Selection);
+        OutGeoNodes.Append(Selection.GeoNodes.data(), (int32)Selection.GeoNodes.size());
+        if (!bLog) return bSelected;
+
+        if (Scene.FirstLOD == INDEX_NONE)
+        {
+            if (RequestedLOD > 0)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF][LOD] No NiLODNode found; ignoring RequestedLOD=%d and importing a single LOD0."), RequestedLOD);
+            }
+            else
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[NIF][LOD] No NiLODNode found; falling back to first TriShape/TriStrips as single LOD0."));
+            }
+            if (!bSelected)
+            {
+                UE_LOG(LogTemp, Error, TEXT("[NIF][LOD] Fallback failed; no non-shadow NiTriShape/NiTriStrips found in scene."));
+            }
+            return bSelected;
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][LOD] NiLODNode '%s' exposes %d LOD bucket(s)"),
+            *Index.Names[Scene.Nodes[Scene.FirstLOD].NameId], (int32)Scene.LODBuckets.size());
+        if (Selection.Bucket == INDEX_NONE)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF][LOD] LOD node has no NiNode children."));
+            return false;
+        }
+
+        if (RequestedLOD >= 0 && RequestedLOD != Selection.Bucket)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF][LOD] RequestedLOD=%d out of range; clamped to %d"), RequestedLOD, Selection.Bucket);
+        }
+        UE_LOG(LogTemp, Log, TEXT("[NIF][LOD] Selecting LOD bucket %d: '%s'"), Selection.Bucket,
+            *Index.Names[Scene.Nodes[Scene.LODBuckets[Selection.Bucket]].NameId]);
+        for (int32 Child : Selection.EmptyChildren)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("[NIF][LOD] No non-shadow TriShape/TriStrips found under child '%s'"),
+                *Index.Names[Scene.Nodes[Child].NameId]);
+        }
+        if (!bSelected)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF][LOD] Selected LOD bucket produced no usable TriShapes/TriStrips."));
+        }
+        return bSelected;
+    }
+
+    // Free one geometry node's niflib vertex, face and weight data unless a node in Keep still needs it; data a
+    // lazy read has not decoded yet is dropped from Lazy instead, so it never is. Returns whether anything was released.
+    static bool ReleaseGeometryData(const NifCore::FSceneNode& Node, const TSet<const NiObject*>& Keep, FNifLazyBlocks& Lazy)
+    {
+        bool bReleased = false;
+        NiGeometryDataRef Data = Node.Geo->GetData();
+        if (Data && !Keep.Contains(Data) && (Lazy.Discard(Data) || Data->GetVertexCount() > 0))
+        {
+            Data->ReleaseVertexData();
+            if (NiTriShapeData* TriData = NifCast<NiTriShapeData>(Data))
+            {
+                TriData->ReleaseTriangles();
+            }
+            else if (NiTriStripsData* StripsData = NifCast<NiTriStripsData>(Data))
+            {
+                StripsData->ReleaseStrips();
+            }
+            bReleased = true;
+        }
+
+        NiSkinInstanceRef Instance = Node.Geo->GetSkinInstance();
+        NiSkinDataRef SkinData = Instance ? Instance->GetSkinData() : NiSkinDataRef();
+        if (SkinData && !Keep.Contains(SkinData))
+        {
+            Lazy.Discard(SkinData);
+            SkinData->ReleaseVertexWeights();
+            bReleased = true;
+        }
+        return bReleased;
+    }
+
+    static int32 GetTriangleCountGeo(const NiGeometryRef& Geo)
+    {
+        if (!Geo) return 0;
+        NiGeometryDataRef GeoData = Geo->GetData();
+        if (!GeoData) return 0;
+        if (NifCast<NiTriShape>(Geo))
+        {
+            if (NiTriShapeData* TriData = NifCast<NiTriShapeData>(GeoData))
+            {
+                return CountShapeTriangles(TriData);
+            }
+        }
+        else if (NifCast<NiTriStrips>(Geo))
+        {
+            if (NiTriStripsData* StripsData = NifCast<NiTriStripsData>(GeoData))
+            {
+                return CountStripsTriangles(StripsData);
+            }
+        }
+        return 0;
+    }
+
+} // anonymous namespace
+
+// ---------- animation: raw key gather (serial, touches niflib) ----------
+namespace
+{
+    // niflib marks unset interpolator poses with -FLT_MAX / FLT_MAX
+    static FORCEINLINE bool IsValidNifFloat(float V)
+    {
+        return FMath::IsFinite(V) && FMath::Abs(V) < 1e30f;
+    }
+
+    // Same row layout LocalToFTransform uses for node rotations
+    static FQuat4f NifRotationToUE(const Matrix33& R)
+    {
+        FMatrix Rot(
+            FPlane((float)R[0][0], (float)R[0][1], (float)R[0][2], 0.f),
+            FPlane((float)R[1][0], (float)R[1][1], (float)R[1][2], 0.f),
+            FPlane((float)R[2][0], (float)R[2][1], (float)R[2][2], 0.f),
+            FPlane(0.f, 0.f, 0.f, 1.f)
+        );
+        return FQuat4f(FQuat(Rot).GetNormalized());
+    }
+
+    static FQuat4f NifQuatToUE(Quaternion Q)
+    {
+        return NifRotationToUE(Q.AsMatrix());
+    }
+
+    // XYZ rotation keys: R = Rx * Ry * Rz, in the same matrix convention as the node rotations
+    static FQuat4f NifEulerToUE(float X, float Y, float Z)
+    {
+        const float SX = FMath::Sin(X), CX = FMath::Cos(X);
+        const float SY = FMath::Sin(Y), CY = FMath::Cos(Y);
+        const float SZ = FMath::Sin(Z), CZ = FMath::Cos(Z);
+
+        Matrix33 R;
+        R[0][0] = CY * CZ;                  R[0][1] = -CY * SZ;                 R[0][2] = SY;
+        R[1][0] = SX * SY * CZ + CX * SZ;   R[1][1] = CX * CZ - SX * SY * SZ;   R[1][2] = -SX * CY;
+        R[2][0] = SX * SZ - CX * SY * CZ;   R[2][1] = CX * SY * SZ + SX * CZ;   R[2][2] = CX * CY;
+        return NifRotationToUE(R);
+    }
+
+    // One animated channel's keys in plain arrays. Quadratic and TBC keys both end up as Hermite tangents, or for
+    // rotations as squad inner quaternions.
+    template <typename T>
+    struct FRawChannel
+    {
+        bool bHermite = false;
+        bool bStep = false;
+        TArray<float> Times;
+        TArray<T> Values;
+        TArray<T> OutTangents;      // forward tangent of each key (bHermite); rotations: outgoing squad control
+        TArray<T> InTangents;       // backward tangent of each key (bHermite); rotations: incoming squad control
+
+        bool IsEmpty() const { return Times.Num() == 0; }
+    };
+
+    struct FRawTrack
+    {
+        FString BoneName;
+
+        FRawChannel<FVector3f> Translation;
+        FRawChannel<FQuat4f>   Rotation;
+        FRawChannel<float>     Scale;
+        FRawChannel<float>     Euler[3];
+        bool bEulerRotation = false;
+
+        // Static pose from the interpolator, used when a channel has no keys
+        TOptional<FVector3f> ConstTranslation;
+        TOptional<FQuat4f>   ConstRotation;
+        TOptional<float>     ConstScale;
+    };
+
+    struct FRawSequence
+    {
+        FString Name;
+        float StartTime = 0.f;
+        float StopTime = 0.f;
+        TArray<FRawTrack> Tracks;
+    };
+
+    // Kochanek-Bartels tangents for TBC keys
+    template <typename T, typename KeyT>
+    static void ComputeTBCTangents(const vector<Key<KeyT>>& Keys, FRawChannel<T>& Ch)
+    {
+        const int32 N = Ch.Values.Num();
+        Ch.OutTangents.SetNumUninitialized(N);
+        Ch.InTangents.SetNumUninitialized(N);
+        for (int32 i = 0; i < N; ++i)
+        {
+            const T& P = Ch.Values[i];
+            const T DPrev = (i > 0) ? (P - Ch.Values[i - 1]) : (Ch.Values[FMath::Min(i + 1, N - 1)] - P);
+            const T DNext = (i + 1 < N) ? (Ch.Values[i + 1] - P) : DPrev;
+
+            const float Tn = Keys[i].tension, B = Keys[i].bias, C = Keys[i].continuity;
+            Ch.InTangents[i] = DPrev * (0.5f * (1.f - Tn) * (1.f - C) * (1.f + B)) + DNext * (0.5f * (1.f - Tn) * (1.f + C) * (1.f - B));
+            Ch.OutTangents[i] = DPrev * (0.5f * (1.f - Tn) * (1.f + C) * (1.f + B)) + DNext * (0.5f * (1.f - Tn) * (1.f - C) * (1.f - B));
+        }
+    }
+
+    static void GatherFloatKeys(const vector<Key<float>>& Keys, KeyType Type, FRawChannel<float>& Ch)
+    {
+        const int32 N = (int32)Keys.size();
+        Ch.Times.SetNumUninitialized(N);
+        Ch.Values.SetNumUninitialized(N);
+        for (int32 i = 0; i < N; ++i)
+        {
+            Ch.Times[i] = Keys[i].time;
+            Ch.Values[i] = Keys[i].data;
+        }
+
+        Ch.bStep = (Type == CONST_KEY);
+        if (Type == QUADRATIC_KEY)
+        {
+            Ch.bHermite = true;
+            Ch.OutTangents.SetNumUninitialized(N);
+            Ch.InTangents.SetNumUninitialized(N);
+            for (int32 i = 0; i < N; ++i)
+            {
+                Ch.OutTangents[i] = Keys[i].forward_tangent;
+                Ch.InTangents[i] = Keys[i].backward_tangent;
+            }
+        }
+        else if (Type == TBC_KEY)
+        {
+            Ch.bHermite = true;
+            ComputeTBCTangents(Keys, Ch);
+        }
+    }
+
+    static void GatherVectorKeys(const vector<Key<Vector3>>& Keys, KeyType Type, FRawChannel<FVector3f>& Ch)
+    {
+        const int32 N = (int32)Keys.size();
+        Ch.Times.SetNumUninitialized(N);
+        Ch.Values.SetNumUninitialized(N);
+        for (int32 i = 0; i < N; ++i)
+        {
+            Ch.Times[i] = Keys[i].time;
+            Ch.Values[i] = ToUE(Keys[i].data);
+        }
+
+        Ch.bStep = (Type == CONST_KEY);
+        if (Type == QUADRATIC_KEY)
+        {
+            Ch.bHermite = true;
+            Ch.OutTangents.SetNumUninitialized(N);
+            Ch.InTangents.SetNumUninitialized(N);
+            for (int32 i = 0; i < N; ++i)
+            {
+                Ch.OutTangents[i] = ToUE(Keys[i].forward_tangent);
+                Ch.InTangents[i] = ToUE(Keys[i].backward_tangent);
+            }
+        }
+        else if (Type == TBC_KEY)
+        {
+            Ch.bHermite = true;
+            ComputeTBCTangents(Keys, Ch);
+        }
+    }
+
+    // Squad inner quaternions for quadratic and TBC rotation keys. Quaternion keys carry no stored tangents (only TBC
+    // keys carry tension/bias/continuity), so like Gamebryo this derives them from the neighbouring keys in log space:
+    // the Kochanek-Bartels tangents of the float channels, with quadratic keys as the zero-TBC (Catmull-Rom) case.
+    static void ComputeSquadControls(const vector<Key<Quaternion>>& Keys, bool bTBC, FRawChannel<FQuat4f>& Ch)
+    {
+        const int32 N = Ch.Values.Num();
+        Ch.OutTangents.SetNumUninitialized(N);
+        Ch.InTangents.SetNumUninitialized(N);
+        for (int32 i = 0; i < N; ++i)
+        {
+            const FQuat4f& Q = Ch.Values[i];
+            if (N == 1)
+            {
+                Ch.OutTangents[i] = Ch.InTangents[i] = Q;
+                continue;
+            }
+
+            // Log-space steps from the previous key and to the next one; an end key mirrors its only neighbour
+            FQuat4f DPrev = (i > 0) ? (Ch.Values[i - 1].Inverse() * Q).Log() : FQuat4f(0.f, 0.f, 0.f, 0.f);
+            FQuat4f DNext = (i + 1 < N) ? (Q.Inverse() * Ch.Values[i + 1]).Log() : DPrev;
+            if (i == 0) DPrev = DNext;
+
+            const float Tn = bTBC ? Keys[i].tension : 0.f;
+            const float B = bTBC ? Keys[i].bias : 0.f;
+            const float C = bTBC ? Keys[i].continuity : 0.f;
+            const FQuat4f TanIn = DPrev * (0.5f * (1.f - Tn) * (1.f - C) * (1.f + B)) + DNext * (0.5f * (1.f - Tn) * (1.f + C) * (1.f - B));
+            const FQuat4f TanOut = DPrev * (0.5f * (1.f - Tn) * (1.f + C) * (1.f + B)) + DNext * (0.5f * (1.f - Tn) * (1.f - C) * (1.f - B));
+
+            Ch.OutTangents[i] = Q * ((TanOut - DNext) * 0.5f).Exp();
+            Ch.InTangents[i] = Q * ((DPrev - TanIn) * 0.5f).Exp();
+        }
+    }
+
+    // Linear keys slerp; quadratic and TBC keys go through squad with the controls above
+    static void GatherQuatKeys(const vector<Key<Quaternion>>& Keys, KeyType Type, FRawChannel<FQuat4f>& Ch)
+    {
+        const int32 N = (int32)Keys.size();
+        Ch.Times.SetNumUninitialized(N);
+        Ch.Values.SetNumUninitialized(N);
+        for (int32 i = 0; i < N; ++i)
+        {
+            Ch.Times[i] = Keys[i].time;
+            FQuat4f Q = NifQuatToUE(Keys[i].data);
+            // Keep consecutive keys in one hemisphere so slerp takes the short arc
+            if (i > 0 && (Ch.Values[i - 1] | Q) < 0.f)
+            {
+                Q = -Q;
+            }
+            Ch.Values[i] = Q;
+        }
+        Ch.bStep = (Type == CONST_KEY);
+        if (Type == QUADRATIC_KEY || Type == TBC_KEY)
+        {
+            Ch.bHermite = true;
+            ComputeSquadControls(Keys, Type == TBC_KEY, Ch);
+        }
+    }
+
+    static void GatherKeyframeData(const NiKeyframeDataRef& Data, FRawTrack& Track)
+    {
+        if (!Data) return;
+
+        if (Data->GetRotateType() == XYZ_ROTATION_KEY)
+        {
+            Track.bEulerRotation = true;
+            GatherFloatKeys(Data->GetXRotateKeys(), Data->GetXRotateType(), Track.Euler[0]);
+            GatherFloatKeys(Data->GetYRotateKeys(), Data->GetYRotateType(), Track.Euler[1]);
+            GatherFloatKeys(Data->GetZRotateKeys(), Data->GetZRotateType(), Track.Euler[2]);
+        }
+        else
+        {
+            GatherQuatKeys(Data->GetQuatRotateKeys(), Data->GetRotateType(), Track.Rotation);
+        }
+        GatherVectorKeys(Data->GetTranslateKeys(), Data->GetTranslateType(), Track.Translation);
+        GatherFloatKeys(Data->GetScaleKeys(), Data->GetScaleType(), Track.Scale);
+    }
+
+    static void GatherInterpolator(const NiInterpolatorRef& Interp, int32 NumFrames, FRawTrack& Track)
+    {
+        if (NiTransformInterpolator* TI = NifCast<NiTransformInterpolator>(Interp))
+        {
+            const Vector3 T = TI->GetTranslation();
+            if (IsValidNifFloat(T.x) && IsValidNifFloat(T.y) && IsValidNifFloat(T.z))
+                Track.ConstTranslation = ToUE(T);
+
+            const Quaternion Q = TI->GetRotation();
+            if (IsValidNifFloat(Q.w) && IsValidNifFloat(Q.x) && IsValidNifFloat(Q.y) && IsValidNifFloat(Q.z))
+                Track.ConstRotation = NifQuatToUE(Q);
+
+            const float S = TI->GetScale();
+            if (IsValidNifFloat(S))
+                Track.ConstScale = S;
+
+            GatherKeyframeData(StaticCast<NiKeyframeData>(TI->GetData()), Track);
+        }
+        else if (NiBSplineTransformInterpolator* BI = NifCast<NiBSplineTransformInterpolator>(Interp))
+        {
+            // Compressed or not, let niflib evaluate the cubic spline at our frame count; the result is linear keys
+            const int32 NumPoints = FMath::Max(2, NumFrames);
+            GatherQuatKeys(BI->SampleQuatRotateKeys(NumPoints, 3), LINEAR_KEY, Track.Rotation);
+            GatherVectorKeys(BI->SampleTranslateKeys(NumPoints, 3), LINEAR_KEY, Track.Translation);
+            GatherFloatKeys(BI->SampleScaleKeys(NumPoints, 3), LINEAR_KEY, Track.Scale);
+
+            const Vector3 T = BI->GetTranslation();
+            if (IsValidNifFloat(T.x) && IsValidNifFloat(T.y) && IsValidNifFloat(T.z))
+                Track.ConstTranslation = ToUE(T);
+
+            const Quaternion Q = BI->GetRotation();
+            if (IsValidNifFloat(Q.w) && IsValidNifFloat(Q.x) && IsValidNifFloat(Q.y) && IsValidNifFloat(Q.z))
+                Track.ConstRotation = NifQuatToUE(Q);
+
+            const float S = BI->GetScale();
+            if (IsValidNifFloat(S))
+                Track.ConstScale = S;
+        }
+    }
+
+    static int32 NumFramesFor(float StartTime, float StopTime, float SampleRate)
+    {
+        return FMath::Max(1, FMath::RoundToInt(FMath::Max(0.f, StopTime - StartTime) * SampleRate) + 1);
+    }
+
+    static FString GetControlledName(const ControllerLink& Link)
+    {
+        if (!Link.nodeName.empty()) return UTF8_TO_TCHAR(Link.nodeName.c_str());
+        if (Link.stringPalette && Link.nodeNameOffset != 0xFFFFFFFFu)
+            return UTF8_TO_TCHAR(Link.stringPalette->GetSubStr((short)Link.nodeNameOffset).c_str());
+        return UTF8_TO_TCHAR(Link.targetName.c_str());
+    }
+
+    static void GatherSequence(const NiControllerSequenceRef& Seq, float SampleRate, FRawSequence& Out)
+    {
+        Out.Name = UTF8_TO_TCHAR(Seq->GetName().c_str());
+        Out.StartTime = Seq->GetStartTime();
+        Out.StopTime = Seq->GetStopTime();
+        const int32 NumFrames = NumFramesFor(Out.StartTime, Out.StopTime, SampleRate);
+
+        const vector<ControllerLink> Links = Seq->GetControllerData();
+        Out.Tracks.Reserve((int32)Links.size());
+        for (const ControllerLink& Link : Links)
+        {
+            NiInterpolatorRef Interp = Link.interpolator;
+            if (!Interp)
+            {
+                // Pre-10.1.0.104 sequences link controllers rather than interpolators
+                if (NiKeyframeController* KC = NifCast<NiKeyframeController>(Link.controller))
+                {
+                    FRawTrack& Track = Out.Tracks.AddDefaulted_GetRef();
+                    Track.BoneName = CanonName(GetControlledName(Link));
+                    GatherKeyframeData(KC->GetData(), Track);
+                }
+                continue;
+            }
+            if (!NifCast<NiTransformInterpolator>(Interp) && !NifCast<NiBSplineTransformInterpolator>(Interp))
+            {
+                continue; // float/color/visibility channels have no bone to drive
+            }
+
+            FRawTrack& Track = Out.Tracks.AddDefaulted_GetRef();
+            Track.BoneName = CanonName(GetControlledName(Link));
+            GatherInterpolator(Interp, NumFrames, Track);
+        }
+    }
+
+    // Files without sequences (pre-10.1) keep one NiKeyframeController per animated node; treat them as one clip
+    static bool GatherNodeControllers(const std::vector<NiObjectRef>& Objects, float SampleRate, FRawSequence& Out)
+    {
+        Out.Name = TEXT("Default");
+        Out.StartTime = TNumericLimits<float>::Max();
+        Out.StopTime = TNumericLimits<float>::Lowest();
+
+        for (const NiObjectRef& Obj : Objects)
+        {
+            NiKeyframeController* KC = NifCast<NiKeyframeController>(Obj);
+            if (!KC) continue;
+
+            NiObjectNETRef Target = KC->GetTarget();
+            if (!Target) continue;
+
+            Out.StartTime = FMath::Min(Out.StartTime, KC->GetStartTime());
+            Out.StopTime = FMath::Max(Out.StopTime, KC->GetStopTime());
+
+            FRawTrack& Track = Out.Tracks.AddDefaulted_GetRef();
+            Track.BoneName = CanonName(UTF8_TO_TCHAR(Target->GetName().c_str()));
+            if (NiInterpolatorRef Interp = KC->GetInterpolator())
+            {
+                GatherInterpolator(Interp, NumFramesFor(KC->GetStartTime(), KC->GetStopTime(), SampleRate), Track);
+            }
+            else
+            {
+                GatherKeyframeData(KC->GetData(), Track);
+            }
+        }
+
+        if (Out.Tracks.Num() == 0) return false;
+        if (Out.StopTime < Out.StartTime) Out.StartTime = Out.StopTime = 0.f;
+        return true;
+    }
+}
+
+// ---------- animation: resampling (parallel, no niflib) ----------
+namespace
+{
+    // Per-worker scratch so resampling a track allocates nothing once warmed up
+    struct FResampleScratch
+    {
+        TArray<int32> Segment;
+        TArray<float> Alpha;
+        TArray<float> Angles[3];
+    };
+
+    // For sorted sample times, find each sample's key segment and the blend within it (one forward walk)
+    static void LocateSamples(const TArray<float>& KeyTimes, const float* SampleTimes, int32 NumSamples, bool bStep, FResampleScratch& Scratch)
+    {
+        Scratch.Segment.SetNumUninitialized(NumSamples, false);
+        Scratch.Alpha.SetNumUninitialized(NumSamples, false);
+
+        const int32 NumKeys = KeyTimes.Num();
+        int32 Seg = 0;
+        for (int32 s = 0; s < NumSamples; ++s)
+        {
+            const float T = SampleTimes[s];
+            while (Seg + 2 < NumKeys && KeyTimes[Seg + 1] <= T) ++Seg;
+
+            float A = 0.f;
+            if (NumKeys >= 2)
+            {
+                const float T0 = KeyTimes[Seg], T1 = KeyTimes[Seg + 1];
+                A = (T1 > T0) ? FMath::Clamp((T - T0) / (T1 - T0), 0.f, 1.f) : 1.f;
+                if (bStep) A = (A >= 1.f) ? 1.f : 0.f;
+            }
+            Scratch.Segment[s] = Seg;
+            Scratch.Alpha[s] = A;
+        }
+    }
+
+    template <typename T>
+    static void EvaluateChannel(const FRawChannel<T>& Ch, const FResampleScratch& Scratch, int32 NumSamples, T* Out)
+    {
+        const int32 NumKeys = Ch.Values.Num();
+        if (NumKeys == 1)
+        {
+            for (int32 s = 0; s < NumSamples; ++s) Out[s] = Ch.Values[0];
+            return;
+        }
+
+        const int32* Seg = Scratch.Segment.GetData();
+        const float* Alpha = Scratch.Alpha.GetData();
+        const T* V = Ch.Values.GetData();
+        if (!Ch.bHermite)
+        {
+            for (int32 s = 0; s < NumSamples; ++s)
+            {
+                const int32 k = Seg[s];
+                Out[s] = V[k] + (V[k + 1] - V[k]) * Alpha[s];
+            }
+            return;
+        }
+
+        const T* OutTan = Ch.OutTangents.GetData();
+        const T* InTan = Ch.InTangents.GetData();
+        for (int32 s = 0; s < NumSamples; ++s)
+        {
+            const int32 k = Seg[s];
+            const float t = Alpha[s], t2 = t * t, t3 = t2 * t;
+            const float H00 = 2.f * t3 - 3.f * t2 + 1.f;
+            const float H10 = t3 - 2.f * t2 + t;
+            const float H01 = -2.f * t3 + 3.f * t2;
+            const float H11 = t3 - t2;
+            Out[s] = V[k] * H00 + OutTan[k] * H10 + V[k + 1] * H01 + InTan[k + 1] * H11;
+        }
+    }
+
+    static void EvaluateRotation(const FRawChannel<FQuat4f>& Ch, const FResampleScratch& Scratch, int32 NumSamples, FQuat4f* Out)
+    {
+        const int32 NumKeys = Ch.Values.Num();
+        for (int32 s = 0; s < NumSamples; ++s)
+        {
+            if (NumKeys == 1)
+            {
+                Out[s] = Ch.Values[0];
+                continue;
+            }
+            const int32 k = Scratch.Segment[s];
+            const float t = Scratch.Alpha[s];
+            if (!Ch.bHermite)
+            {
+                Out[s] = FQuat4f::Slerp(Ch.Values[k], Ch.Values[k + 1], t);
+                continue;
+            }
+
+            // squad(q_k, a_k, b_k+1, q_k+1; t), blended the way FQuat::Squad does
+            const FQuat4f Outer = FQuat4f::Slerp(Ch.Values[k], Ch.Values[k + 1], t);
+            const FQuat4f Inner = FQuat4f::SlerpFullPath(Ch.OutTangents[k], Ch.InTangents[k + 1], t);
+            Out[s] = FQuat4f::SlerpFullPath(Outer, Inner, 2.f * t * (1.f - t));
+        }
+    }
+
+    static void ResampleTrack(const FRawTrack& Raw, const FTransform& BindPose, const TArray<float>& SampleTimes, FResampleScratch& Scratch, FNifKeyframeTrack& Out)
+    {
+        const int32 NumSamples = SampleTimes.Num();
+        Out.Translations.SetNumUninitialized(NumSamples);
+        Out.Rotations.SetNumUninitialized(NumSamples);
+        Out.Scales.SetNumUninitialized(NumSamples);
+
+        // Translation
+        if (!Raw.Translation.IsEmpty())
+        {
+            LocateSamples(Raw.Translation.Times, SampleTimes.GetData(), NumSamples, Raw.Translation.bStep, Scratch);
+            EvaluateChannel(Raw.Translation, Scratch, NumSamples, Out.Translations.GetData());
+        }
+        else
+        {
+            const FVector3f T = Raw.ConstTranslation.Get(FVector3f(BindPose.GetTranslation()));
+            for (int32 s = 0; s < NumSamples; ++s) Out.Translations[s] = T;
+        }
+
+        // Rotation
+        if (Raw.bEulerRotation)
+        {
+            for (int32 Axis = 0; Axis < 3; ++Axis)
+            {
+                TArray<float>& Angles = Scratch.Angles[Axis];
+                Angles.SetNumUninitialized(NumSamples, false);
+                const FRawChannel<float>& Ch = Raw.Euler[Axis];
+                if (Ch.IsEmpty())
+                {
+                    FMemory::Memzero(Angles.GetData(), NumSamples * sizeof(float));
+                    continue;
+                }
+                LocateSamples(Ch.Times, SampleTimes.GetData(), NumSamples, Ch.bStep, Scratch);
+                EvaluateChannel(Ch, Scratch, NumSamples, Angles.GetData());
+            }
+            for (int32 s = 0; s < NumSamples; ++s)
+            {
+                Out.Rotations[s] = NifEulerToUE(Scratch.Angles[0][s], Scratch.Angles[1][s], Scratch.Angles[2][s]);
+            }
+        }
+        else if (!Raw.Rotation.IsEmpty())
+        {
+            LocateSamples(Raw.Rotation.Times, SampleTimes.GetData(), NumSamples, Raw.Rotation.bStep, Scratch);
+            EvaluateRotation(Raw.Rotation, Scratch, NumSamples, Out.Rotations.GetData());
+        }
+        else
+        {
+            const FQuat4f R = Raw.ConstRotation.Get(FQuat4f(BindPose.GetRotation()));
+            for (int32 s = 0; s < NumSamples; ++s) Out.Rotations[s] = R;
+        }
+
+        // Scale (uniform in NIF)
+        if (!Raw.Scale.IsEmpty())
+        {
+            TArray<float>& Uniform = Scratch.Angles[0];
+            Uniform.SetNumUninitialized(NumSamples, false);
+            LocateSamples(Raw.Scale.Times, SampleTimes.GetData(), NumSamples, Raw.Scale.bStep, Scratch);
+            EvaluateChannel(Raw.Scale, Scratch, NumSamples, Uniform.GetData());
+            for (int32 s = 0; s < NumSamples; ++s) Out.Scales[s] = FVector3f(Uniform[s]);
+        }
+        else
+        {
+            const FVector3f S = Raw.ConstScale.IsSet() ? FVector3f(Raw.ConstScale.GetValue()) : FVector3f(BindPose.GetScale3D());
+            for (int32 s = 0; s < NumSamples; ++s) Out.Scales[s] = S;
+        }
+    }
+}
+
+// Expand the SoA payload into the per-vertex FNifMeshData layout (legacy ParseNifFile* API)
+static void StreamsToMeshData(const FNifMeshStreams& In, FNifMeshData& Out)
+{
+    const int32 NumVerts = In.NumVertices();
+    const int32 K = In.MaxInfluences;
+
+    Out.Bones = In.Bones;
+    Out.Materials = In.Materials;
+    Out.Vertices.SetNum(NumVerts);
+    for (int32 v = 0; v < NumVerts; ++v)
+    {
+        FNifVertex& V = Out.Vertices[v];
+        V.Position = In.Positions[v];
+        V.Normal = In.Normals[v];
+        V.UV = In.UVs[v];
+        V.Color = In.Colors[v];
+        V.Tangent = In.Tangents[v];
+        V.Bitangent = In.Bitangents[v];
+        for (int32 k = 0; k < K && In.BoneIndices[v * K + k] != INDEX_NONE; ++k)
+        {
+            FNifVertexInfluence& I = V.Influences.AddDefaulted_GetRef();
+            I.BoneIndex = In.BoneIndices[v * K + k];
+            I.Weight = In.BoneWeights[v * K + k];
+        }
+    }
+
+    const int32 NumFaces = In.NumFaces();
+    Out.Faces.SetNum(NumFaces);
+    for (int32 f = 0; f < NumFaces; ++f)
+    {
+        FNifFace& F = Out.Faces[f];
+        F.Indices[0] = In.Indices[f * 3 + 0];
+        F.Indices[1] = In.Indices[f * 3 + 1];
+        F.Indices[2] = In.Indices[f * 3 + 2];
+        F.MaterialIndex = In.FaceMaterials[f];
+    }
+}
+
+namespace
+{
+    static std::atomic<int32> GNumLiveNifScenes{ 0 };
+    static std::atomic<int32> GNumDeferredReleases{ 0 };   // scenes handed to ReleaseNifSceneDeferred, not yet freed
+}
+
+struct FNifScene
+{
+    FString Path;
+    NifInfo Info;
+    vector<NiObjectRef> Roots;
+    mutable FNifLazyBlocks Lazy;              // heavy data blocks not decoded yet (see bLazyBlockDecoding)
+    std::vector<std::string> HeaderStrings;   // 20.1+ header string table; seeds the index's name table
+    FNifSceneIndex Index;
+    int32 AuthoredLODCount = 1;
+    bool bStreaming = false;                  // geometry data is freed as it is consumed (see OpenNifScene)
+
+    FNifScene() { ++GNumLiveNifScenes; }
+    ~FNifScene() { --GNumLiveNifScenes; }
+};
+
+namespace
+{
+    // Lazy scenes: decode the geometry and skin data of the selected nodes (together, so they decode in parallel).
+    // False if the file's data blocks do not match its header, in which case nothing can be extracted from it.
+    static bool DecodeGeometryData(const FNifScene& Scene, const TArray<int32>& GeoNodes)
+    {
+        if (Scene.Lazy.NumPending() == 0) return !Scene.Lazy.HasFailed();
+
+        TArray<NiObject*> Objects;
+        for (int32 NodeIdx : GeoNodes)
+        {
+            NiGeometry* Geo = Scene.Index.Core.Nodes[NodeIdx].Geo;
+            Objects.Add(Geo->GetData());
+            if (NiSkinInstanceRef Instance = Geo->GetSkinInstance())
+            {
+                Objects.Add(Instance->GetSkinData());
+            }
+        }
+        return Scene.Lazy.EnsureDecoded(Objects);
+    }
+}
+
+namespace FNiflibBridge
+{
+    void LogMemoryStage(const FString& Path, const TCHAR* Stage)
+    {
+        const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Mem] %s %s: RSS=%.1f MB Peak=%.1f MB"),
+            *FPaths::GetCleanFilename(Path), Stage,
+            (double)Stats.UsedPhysical / (1024.0 * 1024.0), (double)Stats.PeakUsedPhysical / (1024.0 * 1024.0));
+    }
+
+    FNifScene* OpenNifScene(const FString& Path, bool bStreaming)
+    {
+        LLM_SCOPE_BYNAME(TEXT("Nif/Open"));
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        std::string NativePath = TCHAR_TO_UTF8(*Path);
+
+        FNifScene* Scene = new FNifScene();
+        Scene->Path = Path;
+        Scene->bStreaming = bStreaming;
+
+        const uint64 ReadStartCycles = FPlatformTime::Cycles64();
+        if (bUseMappedReader && bLazyBlockDecoding)
+        {
+            Scene->Roots = FNifReader::ReadNifListLazy(Path, Scene->Info, Scene->Lazy, &Scene->HeaderStrings);
+        }
+        else if (bUseMappedReader)
+        {
+            Scene->Roots = FNifReader::ReadNifListMapped(Path, Scene->Info, true, &Scene->HeaderStrings);
+        }
+        else
+        {
+            FNifReader::EnsureObjectRegistry();
+            Scene->Roots = ReadNifList(NativePath, &Scene->Info);
+        }
+        const double ReadMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - ReadStartCycles);
+        const int64 FileBytes = IFileManager::Get().FileSize(*Path);
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Read (%s) %lld bytes in %.3f ms (%.1f MB/s), deferred %d blocks (%lld bytes)"),
+            bUseMappedReader ? TEXT("mapped") : TEXT("istream"), FileBytes, ReadMs,
+            ReadMs > 0.0 ? (double)FileBytes / (1024.0 * 1024.0) / (ReadMs / 1000.0) : 0.0,
+            Scene->Lazy.NumPending(), Scene->Lazy.GetPendingBytes());
+
+        if (Scene->Roots.empty())
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] No root objects in file: %s"), *Path);
+            delete Scene;
+            return nullptr;
+        }
+
+        const uint64 IndexStartCycles = FPlatformTime::Cycles64();
+        BuildSceneIndex(Scene->Roots, Scene->HeaderStrings, Scene->Index);
+        Scene->AuthoredLODCount = Scene->Index.Core.AuthoredLODCount;
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Scene index: Nodes=%d Geometries=%d Skins=%d Names=%d (header %d) in %.3f ms"),
+            (int32)Scene->Index.Core.Nodes.size(), Scene->Index.Core.NumGeometries, (int32)Scene->Index.Core.Skins.size(),
+            Scene->Index.Names.Num(), (int32)Scene->HeaderStrings.size(),
+            FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - IndexStartCycles));
+        UE_LOG(LogTemp, Log, TEXT("[NIF] Opened %s (Blocks=%d, AuthoredLODs=%d)"),
+            *Path, (int32)Scene->Roots.size(), Scene->AuthoredLODCount);
+        if (bStreaming)
+        {
+            // Requests past the last bucket (and any request without a NiLODNode) are clamped onto a LOD that is
+            // also extracted on its own; probe every index the importers ask for and keep those geometries around
+            TMap<int32, int32> TimesSelected;
+            TArray<int32> GeoNodes;
+            for (int32 LodIdx = 0; LodIdx < FMath::Max(2, Scene->AuthoredLODCount); ++LodIdx)
+            {
+                if (!SelectLODGeometries(Scene->Index, LodIdx, false, GeoNodes)) continue;
+                for (int32 NodeIdx : GeoNodes)
+                {
+                    if (++TimesSelected.FindOrAdd(NodeIdx) == 2)
+                    {
+                        Scene->Index.ReselectedGeometries.Add(NodeIdx);
+                    }
+                }
+            }
+            LogMemoryStage(Path, TEXT("opened"));
+        }
+        return Scene;
+    }
+
+    int32 ReleaseUnusedLODs(FNifScene* Scene, int32 FirstLOD, int32 NumLODs)
+    {
+        if (!Scene || !Scene->bStreaming || !bReleaseConsumedNifData) return 0;
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+
+        const FNifSceneIndex& Index = Scene->Index;
+        TSet<int32> KeepNodes;
+        TSet<const NiObject*> KeepData;
+        TArray<int32> GeoNodes;
+        for (int32 LodIdx = FMath::Max(0, FirstLOD); LodIdx < FirstLOD + NumLODs; ++LodIdx)
+        {
+            if (!SelectLODGeometries(Index, LodIdx, false, GeoNodes)) continue;
+            for (int32 NodeIdx : GeoNodes)
+            {
+                KeepNodes.Add(NodeIdx);
+                NiGeometry* Geo = Index.Core.Nodes[NodeIdx].Geo;
+                KeepData.Add(Geo->GetData());
+                if (NiSkinInstanceRef Instance = Geo->GetSkinInstance())
+                {
+                    KeepData.Add(Instance->GetSkinData());
+                }
+            }
+        }
+
+        int32 NumReleased = 0;
+        for (int32 i = 0; i < (int32)Index.Core.Nodes.size(); ++i)
+        {
+            const NifCore::FSceneNode& Node = Index.Core.Nodes[i];
+            if (Node.Geo && !KeepNodes.Contains(i) && ReleaseGeometryData(Node, KeepData, Scene->Lazy))
+            {
+                ++NumReleased;
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF] Released %d unused geometries (keeping LOD%d..%d, %d geometries)"),
+            NumReleased, FirstLOD, FirstLOD + NumLODs - 1, KeepNodes.Num());
+        LogMemoryStage(Scene->Path, TEXT("unused LODs released"));
+        return NumReleased;
+    }
+
+    void ReleaseNifScene(FNifScene*& Scene)
+    {
+        if (!Scene) return;
+        LLM_SCOPE_BYNAME(TEXT("Nif/Release"));
+        // Every block's refcount drops to zero in here
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+
+        const uint64 StartCycles = FPlatformTime::Cycles64();
+        const int32 NumBlocks = (int32)Scene->Roots.size();
+        const int32 NumLazyDecoded = Scene->Lazy.NumDecoded();
+        const int32 NumNeverDecoded = Scene->Lazy.NumPending();
+        delete Scene;
+        Scene = nullptr;
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Scene teardown: Blocks=%d (decoded on demand %d, never %d) in %.3f ms"),
+            NumBlocks, NumLazyDecoded, NumNeverDecoded, FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+    }
+
+    void ReleaseNifSceneDeferred(FNifScene*& Scene)
+    {
+        if (!Scene) return;
+
+        // Ownership moves to one pool thread, which runs the whole teardown (under the niflib lock, so it waits for any
+        // parse in flight); nothing else can reach the graph
+        FNifScene* Owned = Scene;
+        Scene = nullptr;
+        ++GNumDeferredReleases;
+        Async(EAsyncExecution::ThreadPool, [Owned]() mutable
+        {
+            ReleaseNifScene(Owned);
+            --GNumDeferredReleases;
+        });
+    }
+
+    void FlushDeferredReleases()
+    {
+        while (GNumDeferredReleases.load() > 0)
+        {
+            FPlatformProcess::Sleep(0.001f);
+        }
+    }
+
+    int32 GetNumLiveScenes()
+    {
+        return GNumLiveNifScenes.load();
+    }
+
+    int32 GetNumBlocks(const FNifScene* Scene)
+    {
+        return Scene ? (int32)Scene->Roots.size() : 0;
+    }
+
+    int32 GetAuthoredLODCount(const FNifScene* Scene)
+    {
+        return Scene ? Scene->AuthoredLODCount : 1;
+    }
+
+    bool ExtractLODStreams(const FNifScene* Scene, int32 RequestedLOD, FNifMeshStreams& OutMesh, FNifAnimationData& OutAnim)
+    {
+        if (!Scene) return false;
+        LLM_SCOPE_BYNAME(TEXT("Nif/Extract"));
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+
+        UE_LOG(LogTemp, Log, TEXT("ParseNifFile: %s (RequestedLOD=%d)"), *Scene->Path, RequestedLOD);
+
+        const FNifSceneIndex& Index = Scene->Index;
+        const int32 MaxInfluences = FMath::Clamp(OutMesh.MaxInfluences, 1, (int32)MAX_TOTAL_INFLUENCES);
+        OutMesh = FNifMeshStreams();
+        OutMesh.MaxInfluences = MaxInfluences;
+
+        FTraversalCtx Ctx{ OutMesh, Index };
+        Ctx.RequestedLOD = RequestedLOD;
+        Ctx.bReleaseConsumed = Scene->bStreaming && bReleaseConsumedNifData;
+
+        TArray<int32> GeoNodes;
+        if (!SelectLODGeometries(Index, RequestedLOD, true, GeoNodes))
+        {
+            return false;
+        }
+        if (!DecodeGeometryData(*Scene, GeoNodes))
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Geometry data of %s is corrupt"), *Scene->Path);
+            return false;
+        }
+        ExtractGeometries(GeoNodes, Ctx);
+
+        // Guarantee at least one root bone
+        if (OutMesh.Bones.Num() == 0)
+        {
+            FNifBone Root;
+            Root.Name = TEXT("Root");
+            Root.ParentIndex = INDEX_NONE;
+            Root.BindPose = FTransform::Identity;
+            OutMesh.Bones.Add(Root);
+        }
+
+        // Ensure we have a material if faces exist
+        if (OutMesh.Materials.Num() == 0 && OutMesh.NumFaces() > 0)
+        {
+            FNifMaterial M; M.Name = TEXT("NifMat");
+            OutMesh.Materials.Add(M);
+        }
+
+        // Clips are resampled once per scene by ExtractAnimations, not per LOD
+        OutAnim = FNifAnimationData();
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF] Accumulated: Vertices=%d Faces=%d Materials=%d Bones=%d MaxInfluences=%d"),
+            OutMesh.NumVertices(), OutMesh.NumFaces(), OutMesh.Materials.Num(), OutMesh.Bones.Num(), OutMesh.MaxInfluences);
+
+        for (int32 i = 0; i < OutMesh.Materials.Num(); ++i)
+        {
+            const auto& M = OutMesh.Materials[i];
+            UE_LOG(LogTemp, Log, TEXT("[NIF] Material[%d] '%s' Diffuse='%s'"), i, *M.Name, *M.DiffuseTexturePath);
+        }
+
+        if (Scene->bStreaming)
+        {
+            LogMemoryStage(Scene->Path, *FString::Printf(TEXT("LOD%d extracted"), RequestedLOD));
+        }
+
+        return OutMesh.NumFaces() > 0;
+    }
+
+    bool ExtractLOD(const FNifScene* Scene, int32 RequestedLOD, FNifMeshData& OutMesh, FNifAnimationData& OutAnim)
+    {
+        FNifMeshStreams Streams;
+        Streams.MaxInfluences = NifDefaultMaxInfluences;
+        const bool bOk = ExtractLODStreams(Scene, RequestedLOD, Streams, OutAnim);
+        StreamsToMeshData(Streams, OutMesh);
+
+        // Legacy single-clip API: hand back the first sequence
+        TArray<FNifAnimationData> Clips;
+        if (bOk && ExtractAnimations(Scene, OutMesh.Bones, DefaultAnimSampleRate, Clips) > 0)
+        {
+            OutAnim = MoveTemp(Clips[0]);
+        }
+        return bOk;
+    }
+
+    int32 ExtractAllLODs(const FNifScene* Scene, TArray<FNifMeshData>& OutLODs, FNifAnimationData& OutAnim)
+    {
+        OutLODs.Reset();
+        if (!Scene) return 0;
+
+        const int32 NumLODs = FMath::Max(1, Scene->AuthoredLODCount);
+        OutLODs.Reserve(NumLODs);
+        for (int32 LodIdx = 0; LodIdx < NumLODs; ++LodIdx)
+        {
+            FNifMeshStreams Streams;
+            Streams.MaxInfluences = NifDefaultMaxInfluences;
+            FNifMeshData& Mesh = OutLODs.AddDefaulted_GetRef();
+            if (!ExtractLODStreams(Scene, LodIdx, Streams, OutAnim) || Streams.NumFaces() == 0 || Streams.NumVertices() == 0)
+            {
+                OutLODs.Pop(false);
+                break;
+            }
+            StreamsToMeshData(Streams, Mesh);
+        }
+
+        TArray<FNifAnimationData> Clips;
+        if (OutLODs.Num() > 0 && ExtractAnimations(Scene, OutLODs[0].Bones, DefaultAnimSampleRate, Clips) > 0)
+        {
+            OutAnim = MoveTemp(Clips[0]);
+        }
+        return OutLODs.Num();
+    }
+
+    int32 ExtractAnimations(const FNifScene* Scene, const TArray<FNifBone>& Bones, float SampleRate, TArray<FNifAnimationData>& OutAnims)
+    {
+        OutAnims.Reset();
+        if (!Scene) return 0;
+        LLM_SCOPE_BYNAME(TEXT("Nif/Animation"));
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        if (!(SampleRate > 0.f)) SampleRate = DefaultAnimSampleRate;
+
+        const uint64 StartCycles = FPlatformTime::Cycles64();
+
+        // Lazy scenes decode key data only once clips are asked for
+        if (!Scene->Lazy.EnsureDecodedOfType(NiKeyframeData::TYPE) || !Scene->Lazy.EnsureDecodedOfType(NiBSplineData::TYPE))
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Key data of %s is corrupt"), *Scene->Path);
+            return 0;
+        }
+
+        // Pass 1 (serial): copy every channel's keys out of niflib; Ref counting there is not thread-safe
+        TArray<FRawSequence> RawSeqs;
+        for (const NiObjectRef& Obj : Scene->Roots)
+        {
+            if (NiControllerSequence* Seq = NifCast<NiControllerSequence>(Obj))
+            {
+                GatherSequence(Seq, SampleRate, RawSeqs.AddDefaulted_GetRef());
+            }
+        }
+        if (RawSeqs.Num() == 0)
+        {
+            FRawSequence Legacy;
+            if (GatherNodeControllers(Scene->Roots, SampleRate, Legacy))
+            {
+                RawSeqs.Add(MoveTemp(Legacy));
+            }
+        }
+        if (RawSeqs.Num() == 0) return 0;
+
+        TMap<FString, int32> BoneByName;
+        for (int32 i = 0; i < Bones.Num(); ++i)
+        {
+            BoneByName.FindOrAdd(CanonName(Bones[i].Name), i);
+        }
+
+        // Lay out the output and a flat work list so the resample pass balances across tracks, not sequences
+        struct FWorkItem { int32 Seq; int32 Track; };
+        TArray<FWorkItem> Work;
+        TArray<TArray<float>> SampleTimes;
+        SampleTimes.SetNum(RawSeqs.Num());
+        OutAnims.SetNum(RawSeqs.Num());
+        for (int32 SeqIdx = 0; SeqIdx < RawSeqs.Num(); ++SeqIdx)
+        {
+            const FRawSequence& Raw = RawSeqs[SeqIdx];
+            FNifAnimationData& Anim = OutAnims[SeqIdx];
+            Anim.Name = Raw.Name;
+            Anim.SampleRate = SampleRate;
+            Anim.Duration = FMath::Max(0.f, Raw.StopTime - Raw.StartTime);
+            Anim.NumFrames = NumFramesFor(Raw.StartTime, Raw.StopTime, SampleRate);
+
+            TArray<float>& Times = SampleTimes[SeqIdx];
+            Times.SetNumUninitialized(Anim.NumFrames);
+            for (int32 f = 0; f < Anim.NumFrames; ++f)
+            {
+                Times[f] = FMath::Min(Raw.StartTime + (float)f / SampleRate, Raw.StopTime);
+            }
+
+            Anim.Tracks.SetNum(Raw.Tracks.Num());
+            for (int32 TrackIdx = 0; TrackIdx < Raw.Tracks.Num(); ++TrackIdx)
+            {
+                FNifKeyframeTrack& Track = Anim.Tracks[TrackIdx];
+                Track.BoneName = Raw.Tracks[TrackIdx].BoneName;
+                if (const int32* Found = BoneByName.Find(Track.BoneName))
+                {
+                    Track.BoneIndex = *Found;
+                }
+                Work.Add({ SeqIdx, TrackIdx });
+            }
+        }
+
+        // Pass 2 (parallel): resample onto the uniform frame grid
+        TArray<FResampleScratch> Scratches;
+        ParallelForWithTaskContext(Scratches, Work.Num(), [&](FResampleScratch& Scratch, int32 WorkIdx)
+        {
+            LLM_SCOPE_BYNAME(TEXT("Nif/Animation"));
+            const FWorkItem& Item = Work[WorkIdx];
+            const FRawSequence& Raw = RawSeqs[Item.Seq];
+            FNifKeyframeTrack& Track = OutAnims[Item.Seq].Tracks[Item.Track];
+
+            const FTransform BindPose = Bones.IsValidIndex(Track.BoneIndex) ? Bones[Track.BoneIndex].BindPose : FTransform::Identity;
+            ResampleTrack(Raw.Tracks[Item.Track], BindPose, SampleTimes[Item.Seq], Scratch, Track);
+
+            Track.Times.SetNumUninitialized(SampleTimes[Item.Seq].Num());
+            for (int32 f = 0; f < Track.Times.Num(); ++f)
+            {
+                Track.Times[f] = SampleTimes[Item.Seq][f] - Raw.StartTime;
+            }
+        });
+
+        int64 NumKeys = 0;
+        int32 NumUnbound = 0;
+        for (const FNifAnimationData& Anim : OutAnims)
+        {
+            for (const FNifKeyframeTrack& Track : Anim.Tracks)
+            {
+                NumKeys += Track.Times.Num();
+                NumUnbound += (Track.BoneIndex == INDEX_NONE) ? 1 : 0;
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF][Perf] Animations: Sequences=%d Tracks=%d (unbound %d) Keys=%lld @ %.0f Hz in %.3f ms"),
+            OutAnims.Num(), Work.Num(), NumUnbound, NumKeys, SampleRate,
+            FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+
+        return OutAnims.Num();
+    }
+
+    bool ParseNifFileWithLOD(const FString& Path, int32 RequestedLOD, FNifMeshData& OutMesh, FNifAnimationData& OutAnim)
+    {
+        // One LOD out of a throwaway scene: everything else can go before the extraction grows the flat mesh
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        FNifScene* Scene = OpenNifScene(Path, true);
+        if (!Scene) return false;
+        ReleaseUnusedLODs(Scene, FMath::Max(0, RequestedLOD), 1);
+
+        const bool bOk = ExtractLOD(Scene, RequestedLOD, OutMesh, OutAnim);
+        ReleaseNifScene(Scene);
+        return bOk;
+    }
+
+    bool ParseNifFile(const FString& Path, FNifMeshData& OutMesh, FNifAnimationData& OutAnim)
+    {
+        return ParseNifFileWithLOD(Path, -1, OutMesh, OutAnim);
+    }
+
+    int32 GetAuthoredLODCount(const FString& Path)
+    {
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        FNifScene* Scene = OpenNifScene(Path);
+        if (!Scene) return 1;
+
+        const int32 Count = GetAuthoredLODCount(Scene);
+        ReleaseNifScene(Scene);
+        return Count;
+    }
+
+    int32 ExtractAnimationsFromFile(const FString& Path, const TArray<FNifBone>& Bones, float SampleRate, TArray<FNifAnimationData>& OutAnims)
+    {
+        OutAnims.Reset();
+        FScopeLock NiflibLock(&FNifReader::GetNiflibLock());
+        FNifScene* Scene = OpenNifScene(Path);
+        if (!Scene) return 0;
+
+        const int32 NumClips = ExtractAnimations(Scene, Bones, SampleRate, OutAnims);
+        ReleaseNifScene(Scene);
+        return NumClips;
+    }
+
+    FString CanonBoneName(const FString& Name)
+    {
+        return CanonName(Name);
+    }
+
+    bool ReadKfmActions(const FString& KfmPath, TArray<FNifKfmAction>& OutActions, FString& OutNifPath)
+    {
+        OutActions.Reset();
+        OutNifPath.Reset();
+
+        Kfm Graph;
+        if (Graph.Read(std::string(TCHAR_TO_UTF8(*KfmPath))) == 0)
+        {
+            UE_LOG(LogTemp, Error, TEXT("[NIF] Failed to read KFM: %s"), *KfmPath);
+            return false;
+        }
+
+        // Paths inside a .kfm are relative to the .kfm itself
+        const FString BaseDir = FPaths::GetPath(KfmPath);
+        auto Resolve = [&BaseDir](const std::string& Rel) -> FString
+        {
+            const FString RelPath = UTF8_TO_TCHAR(Rel.c_str());
+            if (RelPath.IsEmpty()) return FString();
+            FString Full = FPaths::ConvertRelativePathToFull(BaseDir, RelPath);
+            if (!IFileManager::Get().FileExists(*Full))
+            {
+                // Some exporters store the authoring machine's path; fall back to the bare file name
+                Full = BaseDir / FPaths::GetCleanFilename(RelPath);
+            }
+            return Full;
+        };
+
+        OutNifPath = Resolve(Graph.nif_filename);
+        for (const KfmAction& Action : Graph.actions)
+        {
+            FNifKfmAction& Out = OutActions.AddDefaulted_GetRef();
+            Out.Name = UTF8_TO_TCHAR(Action.action_name.c_str());
+            Out.KfPath = Resolve(Action.action_filename);
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("[NIF] KFM %s: Model='%s' Actions=%d"), *KfmPath, *OutNifPath, OutActions.Num());
+        return true;
+    }
+
+    uint64 GetMeshCacheKey(const FString& Path, int32 MaxInfluences, float AnimSampleRate)
+    {
+        if (!bUseMeshCache) return 0;
+
+        // Everything that changes extraction output for the same source bytes goes into the key
+        const uint32 SampleRateMilliHz = (uint32)FMath::RoundToInt(FMath::Max(0.f, AnimSampleRate) * 1000.f);
+        const uint64 SettingsKey =
+            (uint64)FMath::Clamp(MaxInfluences, 1, (int32)MAX_TOTAL_INFLUENCES) |
+            ((uint64)(bCreateStubBonesForUnmappedSkinBones ? 1 : 0) << 8) |
+            ((uint64)SampleRateMilliHz << 32);
+        return FNifMeshCache::ComputeKey(Path, SettingsKey);
+    }
+
+    bool LoadCachedLODs(uint64 CacheKey, TArray<FNifMeshStreams>& OutLODs, TArray<FNifAnimationData>& OutAnims)
+    {
+        if (CacheKey == 0) return false;
+
+        const uint64 LoadStartCycles = FPlatformTime::Cycles64();
+        const bool bHit = FNifMeshCache::Load(CacheKey, OutLODs, OutAnims);
+        if (bHit)
+        {
+            UE_LOG(LogTemp, Log, TEXT("[NIF][Cache] Hit %016llx (LODs=%d, Clips=%d) in %.3f ms"),
+                CacheKey, OutLODs.Num(), OutAnims.Num(), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - LoadStartCycles));
+        }
+        return bHit;
+    }
+
+    void StoreCachedLODs(uint64 CacheKey, const TArray<FNifMeshStreams>& LODs, const TArray<FNifAnimationData>& Anims)
+    {
+        if (CacheKey == 0) return;
+
+        if (FNifMeshCache::Store(CacheKey, LODs, Anims))
+        {
+            UE_LOG(LogTemp, Log, TEXT("[NIF][Cache] Stored %016llx (LODs=%d, Clips=%d)"), CacheKey, LODs.Num(), Anims.Num());
+        }
+    }
+}
@@ -0,0 +1,23 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Modules/ModuleManager.h"
+#include "NifReader.h"
+#include "NiflibBridge.h"
+
+class FNiflibRuntimeModule : public FDefaultModuleImpl
+{
+public:
+    virtual void StartupModule() override
+    {
+        // niflib fills its type registry on first read; fill it here so the first import does not pay for it
+        FNifReader::EnsureObjectRegistry();
+    }
+
+    virtual void ShutdownModule() override
+    {
+        // Deferred teardowns run niflib code; let them finish while it is still loaded
+        FNiflibBridge::FlushDeferredReleases();
+    }
+};
+
+IMPLEMENT_MODULE(FNiflibRuntimeModule, NiflibRuntime)
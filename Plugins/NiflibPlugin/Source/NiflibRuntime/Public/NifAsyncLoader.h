@@ -0,0 +1,80 @@
+// NifAsyncLoader.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Async/Future.h"
+#include "NiflibBridge.h"
+#include "NifAsyncLoader.generated.h"
+
+class AActor;
+class UProceduralMeshComponent;
+
+/** Limits that keep runtime NIF streaming from hitching the game thread. */
+USTRUCT(BlueprintType)
+struct FNifStreamingBudget
+{
+	GENERATED_BODY()
+
+	/** Files read + extracted concurrently on the task pool. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NIF Streaming", meta = (ClampMin = "1"))
+	int32 MaxConcurrentLoads = 2;
+
+	/** Game-thread time per frame spent turning finished loads into components. At least one mesh is spawned per frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NIF Streaming", meta = (ClampMin = "0"))
+	float GameThreadMsPerFrame = 2.0f;
+
+	/** Decoded-but-not-yet-spawned mesh data; no new load starts while this much is waiting. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NIF Streaming", meta = (ClampMin = "1"))
+	int32 MaxPendingMegabytes = 256;
+};
+
+/** Called on the game thread; Component is nullptr if the file failed to load. */
+DECLARE_DELEGATE_OneParam(FOnNifMeshLoaded, UProceduralMeshComponent* /*Component*/);
+
+/**
+ * Loads .nif files at runtime without the editor factory: read + extraction run on the task pool,
+ * and finished meshes become UProceduralMeshComponents (one section per material) within the streaming budget.
+ * Skinned meshes are shown in their bind pose; building a USkeletalMesh needs the editor module.
+ */
+UCLASS()
+class NIFLIBRUNTIME_API UNifAsyncLoader : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Read + extract one LOD off the game thread. Touches no UObjects; the future holds nullptr on failure. */
+	static TFuture<TSharedPtr<FNifMeshStreams>> LoadStreamsAsync(const FString& Path, int32 RequestedLOD = 0);
+
+	/**
+	 * Queue a mesh load. The component is attached to Owner, or to a new actor spawned at Transform when Owner is null.
+	 * OnLoaded fires on the game thread once the component exists.
+	 */
+	void RequestMesh(const FString& Path, const FTransform& Transform, FOnNifMeshLoaded OnLoaded, AActor* Owner = nullptr, int32 RequestedLOD = 0);
+
+	/** Future flavour of RequestMesh; resolved on the game thread. */
+	TFuture<UProceduralMeshComponent*> RequestMeshAsync(const FString& Path, const FTransform& Transform, AActor* Owner = nullptr, int32 RequestedLOD = 0);
+
+	/** Number of requests not yet turned into components. */
+	int32 GetNumPending() const;
+
+	FNifStreamingBudget Budget;
+
+	// USubsystem / FTickableGameObject
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FRequest;
+	struct FSharedState;
+
+	void StartQueuedLoads();
+	void SpawnLoaded(FRequest& Request);
+
+	TArray<TSharedPtr<FRequest, ESPMode::ThreadSafe>> Queued;
+
+	// Shared with in-flight workers so a torn-down world never receives their results
+	TSharedPtr<FSharedState, ESPMode::ThreadSafe> State;
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+#include "HAL/CriticalSection.h"
+
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// --- Niflib headers ---
+#include <niflib.h>
+#include <obj/NiObject.h>
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace Niflib
+{
+	struct Header;
+}
+
+/** Read-only std::streambuf over a contiguous byte range. The whole range is the get area, so reads never underflow and bulk reads are one memcpy. */
+class NIFLIBRUNTIME_API FNifMemoryStreamBuf : public std::streambuf
+{
+public:
+	FNifMemoryStreamBuf(const uint8* Data, int64 Size);
+
+protected:
+	virtual std::streamsize xsgetn(char_type* Dest, std::streamsize Count) override;
+	virtual pos_type seekoff(off_type Off, std::ios_base::seekdir Dir, std::ios_base::openmode Which = std::ios_base::in) override;
+	virtual pos_type seekpos(pos_type Pos, std::ios_base::openmode Which = std::ios_base::in) override;
+};
+
+/** A .nif file's bytes, memory-mapped where the platform supports it, otherwise read in one call. */
+class NIFLIBRUNTIME_API FNifMappedFile
+{
+public:
+	FNifMappedFile();
+	~FNifMappedFile();
+
+	bool Open(const FString& Path);
+
+	const uint8* GetData() const { return Data; }
+	int64 GetSize() const { return Size; }
+	bool IsMapped() const { return Region.IsValid(); }
+
+private:
+	TUniquePtr<IMappedFileHandle> Handle;
+	TUniquePtr<IMappedFileRegion> Region;
+	TArray64<uint8> Fallback;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+};
+
+/**
+ * The heavy data blocks a lazy read left undecoded (geometry data, skin data and partitions, keyframe and B-spline
+ * data): each one exists, linked into the graph, but stays empty until EnsureDecoded reads it from the file bytes
+ * kept here. Belongs to one block graph and, like it, is only used under GetNiflibLock().
+ */
+class NIFLIBRUNTIME_API FNifLazyBlocks
+{
+public:
+	FNifLazyBlocks();
+	~FNifLazyBlocks();
+
+	/**
+	 * Decode whichever of Objects are still pending (across the task graph when there are several), then resolve their links.
+	 * Returns false if a block did not match its declared size; the graph is then unusable and every later call fails too.
+	 */
+	bool EnsureDecoded(TConstArrayView<Niflib::NiObject*> Objects);
+	/** Decode every pending block of Type or a type derived from it. Fails like EnsureDecoded. */
+	bool EnsureDecodedOfType(const Niflib::Type& Type);
+	/** Give up on a pending block: it is never decoded and stays empty. Returns false if it was not pending. */
+	bool Discard(const Niflib::NiObject* Object);
+
+	bool IsPending(const Niflib::NiObject* Object) const { return Pending.Contains(Object); }
+	int32 NumPending() const { return Pending.Num(); }
+	int32 NumDecoded() const { return DecodedBlocks; }
+	int64 GetPendingBytes() const { return PendingBytes; }
+	int64 GetDecodedBytes() const { return DecodedBytes; }
+	bool HasFailed() const { return bFailed; }
+
+	/**
+	 * For FNifReader: take over a read's file, header and block layout. Blocks (borrowed; the block list owns them)
+	 * spans file bytes [Offsets[i], Offsets[i + 1]); the blocks then handed to Defer are the pending ones.
+	 */
+	void Adopt(TUniquePtr<FNifMappedFile> InFile, const Niflib::Header& InHeader, const Niflib::NifInfo& InInfo,
+		TArray<Niflib::NiObject*>&& InBlocks, TArray<int64>&& InOffsets);
+	void Defer(int32 BlockIndex);
+
+private:
+	bool DecodeBlocks(const TArray<int32>& BlockIndices);
+
+	TUniquePtr<FNifMappedFile> File;
+	TUniquePtr<Niflib::Header> Hdr;
+	Niflib::NifInfo Info;
+	TArray<Niflib::NiObject*> Blocks;
+	TArray<int64> Offsets;
+	TMap<const Niflib::NiObject*, int32> Pending;   // block -> index into Blocks
+	int64 PendingBytes = 0;
+	int64 DecodedBytes = 0;
+	int32 DecodedBlocks = 0;
+	bool bFailed = false;
+};
+
+namespace FNifReader
+{
+	/**
+	 * niflib keeps RefObject refcounts and its live-object counter in plain integers inside the prebuilt library, so no
+	 * two threads may create, reference or free niflib objects at the same time. Every reader below, FNifLazyBlocks and
+	 * every FNiflibBridge entry point hold this lock (it is recursive); anything else calling niflib must take it too.
+	 * Work the holder fans out with ParallelFor is covered as long as it only reads blocks through raw pointers.
+	 */
+	NIFLIBRUNTIME_API FCriticalSection& GetNiflibLock();
+
+	/**
+	 * Make sure niflib's block type registry is populated (niflib fills it lazily on the first ReadNifList; see the
+	 * implementation for exactly which niflib internal this relies on).
+	 * The readers below call this; NiflibRuntime also calls it at startup.
+	 */
+	NIFLIBRUNTIME_API void EnsureObjectRegistry();
+
+	/**
+	 * Decode every block of a .nif straight from its mapped bytes. Returns an empty list on failure.
+	 * With bParallelBlocks, 20.2.0.7+ files (which carry per-block sizes in the header) are decoded across the task graph.
+	 * OutStrings, if given, receives the header's string table (20.1.0.1+; empty for older files).
+	 */
+	NIFLIBRUNTIME_API std::vector<Niflib::NiObjectRef> ReadNifListMapped(const FString& Path, Niflib::NifInfo& OutInfo, bool bParallelBlocks = true,
+		std::vector<std::string>* OutStrings = nullptr);
+
+	/**
+	 * ReadNifListMapped, but for 20.2.0.7+ files only the structure (nodes, properties, skin instances, controllers, ...)
+	 * is decoded; heavy data blocks are created and linked but left to OutLazy, which keeps the file open and decodes
+	 * them on demand. Older files carry no block sizes and are decoded in full, leaving OutLazy with nothing pending.
+	 */
+	NIFLIBRUNTIME_API std::vector<Niflib::NiObjectRef> ReadNifListLazy(const FString& Path, Niflib::NifInfo& OutInfo, FNifLazyBlocks& OutLazy,
+		std::vector<std::string>* OutStrings = nullptr);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "CoreMinimal.h"
+
+#include <obj/NiObject.h>
+
+/**
+ * Constant-time niflib subtype tests. Every block class a reader has met is numbered in preorder over the
+ * Type::base_type tree, so "A derives from B" is two integer compares instead of niflib's walk up A's base_type chain.
+ */
+namespace FNifTypeIndex
+{
+	struct FInterval
+	{
+		int32 First = INDEX_NONE;       // preorder number of the type
+		int32 Last = INDEX_NONE;        // largest preorder number in its subtree
+	};
+
+	/**
+	 * By Type::internal_type_number; unnumbered types fall back to niflib's walk. Only changed by Register, which the
+	 * readers call under FNifReader::GetNiflibLock() before they fan out, so it is read-only to every worker.
+	 */
+	extern NIFLIBRUNTIME_API TArray<FInterval> Intervals;
+
+	/** Number BlockType and its bases, renumbering the hierarchy if any of them is new. Caller holds the niflib lock. */
+	NIFLIBRUNTIME_API void Register(const Niflib::Type& BlockType);
+
+	FORCEINLINE bool IsDerived(const Niflib::Type& Type, const Niflib::Type& Base)
+	{
+		const int32 T = Type.internal_type_number;
+		const int32 B = Base.internal_type_number;
+		if (Intervals.IsValidIndex(T) && Intervals.IsValidIndex(B) && Intervals[T].First != INDEX_NONE && Intervals[B].First != INDEX_NONE)
+		{
+			return Intervals[B].First <= Intervals[T].First && Intervals[T].First <= Intervals[B].Last;
+		}
+		return Type.IsDerivedType(Base);   // a class the index does not know
+	}
+}
+
+/**
+ * Borrowed DynamicCast: Obj as a T if it is one, else nullptr. No Ref is made, so refcounts are not touched;
+ * whatever owns Obj (the scene's block list) keeps it alive.
+ */
+template <class T>
+FORCEINLINE T* NifCast(Niflib::NiObject* Obj)
+{
+	return (Obj && FNifTypeIndex::IsDerived(Obj->GetType(), T::TYPE)) ? static_cast<T*>(Obj) : nullptr;
+}
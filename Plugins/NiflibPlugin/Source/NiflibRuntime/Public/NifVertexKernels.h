@@ -0,0 +1,50 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/**
+ * A geometry's NIF-to-UE stream transform: world matrix for positions, rotation-only matrix for
+ * directions (normals, tangents), and the triangle winding that results from both.
+ */
+struct NIFLIBRUNTIME_API FNifStreamTransform
+{
+	FMatrix44f PositionMatrix = FMatrix44f::Identity;   // row-vector convention, translation in row 3
+	FMatrix44f DirectionMatrix = FMatrix44f::Identity;  // rotation only (matches FTransform::TransformVectorNoScale)
+	bool bFlipWinding = true;                           // NIF is right-handed; a mirrored world matrix cancels the flip
+
+	static FNifStreamTransform Make(const FTransform& WorldXf);
+};
+
+/**
+ * Float SIMD kernels over whole vertex streams. Inputs are tightly packed xyz floats (niflib's Vector3
+ * layout); non-finite input components are replaced by 0, as ToUE_FlipV does for UVs.
+ */
+namespace FNifVertexKernels
+{
+	/** Out[i] = In[i] * PositionMatrix. */
+	NIFLIBRUNTIME_API void TransformPositions(const FNifStreamTransform& Xf, const float* InXYZ, int32 Num, FVector3f* Out);
+
+	/** Out[i] = normalize(In[i] * DirectionMatrix); degenerate directions come out as zero (like GetSafeNormal). */
+	NIFLIBRUNTIME_API void TransformDirections(const FNifStreamTransform& Xf, const float* InXYZ, int32 Num, FVector3f* Out);
+
+	/** Widen NumTris uint16 triangles (v1 v2 v3) to uint32 + BaseVertex, swapping v2/v3 when Xf.bFlipWinding. Out holds NumTris * 3. */
+	NIFLIBRUNTIME_API void ConvertTriangles(const FNifStreamTransform& Xf, const uint16* InTris, int32 NumTris, uint32 BaseVertex, uint32* Out);
+
+	/** Triangles a strip of Len indices yields once degenerates (any two corners equal) are dropped. */
+	NIFLIBRUNTIME_API int32 CountStripTriangles(const uint16* Strip, int32 Len);
+
+	/**
+	 * Expand one triangle strip straight into a list: alternating winding, degenerates dropped, Xf.bFlipWinding
+	 * applied and BaseVertex added. Out must hold CountStripTriangles() * 3 entries; returns the triangles written.
+	 */
+	NIFLIBRUNTIME_API int32 ConvertStrip(const FNifStreamTransform& Xf, const uint16* Strip, int32 Len, uint32 BaseVertex, uint32* Out);
+
+	/**
+	 * Clean up NumVerts packed influence rows of K slots (FNifMeshStreams::BoneIndices/BoneWeights) in place: drop
+	 * entries with a bone outside [0, NumBones) or a non-finite / non-positive weight, sort strongest-first,
+	 * renormalize, and give rows left empty a single FallbackBone influence. Returns the entries dropped.
+	 */
+	NIFLIBRUNTIME_API int32 NormalizeInfluences(int32* Bones, float* Weights, int32 NumVerts, int32 K, int32 NumBones, int32 FallbackBone);
+
+	/** Used slots (bone != INDEX_NONE and below NumBones) across NumVerts rows of K; sizes a flat influence list exactly. */
+	NIFLIBRUNTIME_API int32 CountInfluences(const int32* Bones, int32 NumVerts, int32 K, int32 NumBones);
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Bone influences kept per vertex when the caller does not choose (importers, legacy FNifMeshData extraction). */
+static constexpr int32 NifDefaultMaxInfluences = 8;
+
+/** One bone weight on a vertex. */
+struct FNifVertexInfluence
+{
+	int32 BoneIndex = INDEX_NONE;
+	float Weight = 0.f;
+};
+
+/** One vertex as fed to the factory (UE space). */
+struct FNifVertex
+{
+	FVector3f Position = FVector3f::ZeroVector;
+	FVector3f Normal = FVector3f::ZeroVector;
+	FVector2f UV = FVector2f::ZeroVector;           // Always valid; synthesize (0,0) if missing
+	FColor    Color = FColor::White;                  // White if the NIF has no vertex colors
+	FVector3f Tangent = FVector3f::ZeroVector;      // Zero if not authored (factory recomputes)
+	FVector3f Bitangent = FVector3f::ZeroVector;
+	TArray<FNifVertexInfluence> Influences;               // Must end up non-empty (factory normalizes/limits)
+};
+
+/** Triangle (indices point into Vertices). */
+struct FNifFace
+{
+	int32 Indices[3] = { 0, 0, 0 };
+	int32 MaterialIndex = 0;                               // Slot index; factory ensures slots exist
+};
+
+/** Minimal material info (slot naming; texture path optional). */
+struct FNifMaterial
+{
+	FString Name;
+	FString DiffuseTexturePath;
+};
+
+/** Simple bone definition for the reference skeleton. */
+struct FNifBone
+{
+	FString   Name;
+	int32     ParentIndex = INDEX_NONE;                    // -1 for root
+	FTransform BindPose = FTransform::Identity;         // UE-space bind transform
+};
+
+/** Whole mesh payload from the bridge. */
+struct FNifMeshData
+{
+	TArray<FNifVertex>   Vertices;
+	TArray<FNifFace>     Faces;
+	TArray<FNifMaterial> Materials;
+	TArray<FNifBone>     Bones;
+};
+
+/**
+ * Structure-of-arrays mesh payload (UE space). One entry per vertex in every vertex stream;
+ * skin influences are packed MaxInfluences-wide per vertex, strongest first, weights normalized.
+ */
+struct FNifMeshStreams
+{
+	int32 MaxInfluences = NifDefaultMaxInfluences;         // Set before extraction; clamped to [1, MAX_TOTAL_INFLUENCES]
+
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Normals;                             // Zero where not authored
+	TArray<FVector2f> UVs;                                 // UV0; (0,0) where not authored
+	TArray<FColor>    Colors;                              // White where not authored
+	TArray<FVector3f> Tangents;                            // Zero where not authored
+	TArray<FVector3f> Bitangents;
+
+	TArray<int32> BoneIndices;                             // NumVertices() * MaxInfluences; INDEX_NONE = unused slot
+	TArray<float> BoneWeights;                             // NumVertices() * MaxInfluences; 0 in unused slots
+
+	TArray<int32> Indices;                                 // 3 per face, into the vertex streams
+	TArray<int32> FaceMaterials;                           // 1 per face (slot index)
+
+	TArray<FNifMaterial> Materials;
+	TArray<FNifBone>     Bones;
+
+	int32 NumVertices() const { return Positions.Num(); }
+	int32 NumFaces() const { return FaceMaterials.Num(); }
+
+	/** Free the vertex, skin and face streams once they have been consumed; bones and materials stay. */
+	void EmptyStreams()
+	{
+		Positions.Empty();
+		Normals.Empty();
+		UVs.Empty();
+		Colors.Empty();
+		Tangents.Empty();
+		Bitangents.Empty();
+		BoneIndices.Empty();
+		BoneWeights.Empty();
+		Indices.Empty();
+		FaceMaterials.Empty();
+	}
+};
+
+/** Per-bone keyframes, resampled to the clip's SampleRate (one key per frame in every array). */
+struct FNifKeyframeTrack
+{
+	int32 BoneIndex = INDEX_NONE;    // Into the mesh's Bones; INDEX_NONE if the target is not a known bone
+	FString BoneName;                // Animated node name (CanonName applied)
+	TArray<float>     Times;         // seconds
+	TArray<FVector3f> Translations;  // per-key
+	TArray<FQuat4f>   Rotations;     // per-key
+	TArray<FVector3f> Scales;        // per-key
+};
+
+/** One animation clip (an NiControllerSequence, or the per-node controllers of older files). */
+struct FNifAnimationData
+{
+	FString Name;
+	float Duration = 0.f;            // seconds
+	float SampleRate = 30.f;         // frames per second of every track
+	int32 NumFrames = 0;
+	TArray<FNifKeyframeTrack> Tracks;
+};
+
+/** One action of a .kfm action graph. */
+struct FNifKfmAction
+{
+	FString Name;                    // Action name from the .kfm
+	FString KfPath;                  // Absolute path of the action's .kf file
+};
+
+/** Opaque handle to a decoded .nif block graph (see FNiflibBridge::OpenNifScene). */
+struct FNifScene;
+
+namespace FNiflibBridge
+{
+	/** Parse a .nif into simple structs (UE-space, units fixed). Return false to cancel import. */
+	NIFLIBRUNTIME_API bool ParseNifFile(const FString& Path, FNifMeshData& OutMesh, FNifAnimationData& OutAnim);
+	NIFLIBRUNTIME_API bool ParseNifFileWithLOD(const FString& Path, int32 RequestedLOD, FNifMeshData& OutMesh, FNifAnimationData& OutAnim);
+	NIFLIBRUNTIME_API int32 GetAuthoredLODCount(const FString& Path);
+
+	/**
+	 * Read and decode a .nif once so several LODs can be extracted from it. Returns nullptr on failure.
+	 * A streaming scene frees each geometry's niflib vertex, face and skin data as soon as a LOD extraction has emitted it
+	 * (data shared with other geometry nodes stays), so every LOD can be extracted once. Animations are unaffected.
+	 * Geometry, skin and key data of 20.2.0.7+ files is decoded only when an extraction first needs it, so LOD counts and
+	 * single-LOD imports read little more than the node graph.
+	 * Callable from any thread, but niflib's refcounts are not atomic, so every entry point here runs under
+	 * FNifReader::GetNiflibLock(): calls from several threads queue up rather than overlap.
+	 */
+	NIFLIBRUNTIME_API FNifScene* OpenNifScene(const FString& Path, bool bStreaming = false);
+	/** Streaming scenes only: free the geometry data no LOD in [FirstLOD, FirstLOD + NumLODs) selects (other buckets, shadow meshes). Returns the geometries released. */
+	NIFLIBRUNTIME_API int32 ReleaseUnusedLODs(FNifScene* Scene, int32 FirstLOD, int32 NumLODs);
+	/** Log the process's resident and peak resident memory after one stage of converting Path ("[NIF][Mem]"). */
+	NIFLIBRUNTIME_API void LogMemoryStage(const FString& Path, const TCHAR* Stage);
+	/** Number of blocks in an opened scene's graph. */
+	NIFLIBRUNTIME_API int32 GetNumBlocks(const FNifScene* Scene);
+	/** Number of NiLODNode buckets in an opened scene (at least 1). */
+	NIFLIBRUNTIME_API int32 GetAuthoredLODCount(const FNifScene* Scene);
+	/** Same as ParseNifFileWithLOD, but against an already opened scene. */
+	NIFLIBRUNTIME_API bool ExtractLOD(const FNifScene* Scene, int32 RequestedLOD, FNifMeshData& OutMesh, FNifAnimationData& OutAnim);
+	/** Extract one LOD bucket into the SoA payload; OutMesh.MaxInfluences selects the packed influence width. OutAnim is reset (see ExtractAnimations). */
+	NIFLIBRUNTIME_API bool ExtractLODStreams(const FNifScene* Scene, int32 RequestedLOD, FNifMeshStreams& OutMesh, FNifAnimationData& OutAnim);
+	/** Resample every animation clip in the scene at SampleRate; tracks bind to Bones by name. Returns the clip count. */
+	NIFLIBRUNTIME_API int32 ExtractAnimations(const FNifScene* Scene, const TArray<FNifBone>& Bones, float SampleRate, TArray<FNifAnimationData>& OutAnims);
+	/** Open a .kf (or any .nif), resample its clips against Bones and release it. Holds the niflib lock throughout, like OpenNifScene. */
+	NIFLIBRUNTIME_API int32 ExtractAnimationsFromFile(const FString& Path, const TArray<FNifBone>& Bones, float SampleRate, TArray<FNifAnimationData>& OutAnims);
+	/** Bone name as the bridge matches it (exporter "Game_" prefix stripped); compare the results case-insensitively. */
+	NIFLIBRUNTIME_API FString CanonBoneName(const FString& Name);
+	/** Read a .kfm action graph: its actions with resolved .kf paths, and the model .nif it was authored for. */
+	NIFLIBRUNTIME_API bool ReadKfmActions(const FString& KfmPath, TArray<FNifKfmAction>& OutActions, FString& OutNifPath);
+	/** Extract LOD0..N-1 in order; stops at the first bucket that yields no geometry. Returns the LOD count. */
+	NIFLIBRUNTIME_API int32 ExtractAllLODs(const FNifScene* Scene, TArray<FNifMeshData>& OutLODs, FNifAnimationData& OutAnim);
+	/** Free the decoded block graph and null the handle. Safe to call with nullptr. */
+	NIFLIBRUNTIME_API void ReleaseNifScene(FNifScene*& Scene);
+	/**
+	 * Null the handle and free the block graph on a pool thread, so the caller does not pay for tearing down every block.
+	 * For conversion-only callers that are done with the scene; output already extracted from it is unaffected.
+	 */
+	NIFLIBRUNTIME_API void ReleaseNifSceneDeferred(FNifScene*& Scene);
+	/** Block until every scene handed to ReleaseNifSceneDeferred has been freed. */
+	NIFLIBRUNTIME_API void FlushDeferredReleases();
+	/** Scenes opened and not freed yet, including those waiting on a deferred release. */
+	NIFLIBRUNTIME_API int32 GetNumLiveScenes();
+
+	/** Key of Path's extracted LODs + clips in the on-disk cache (file bytes + extraction settings; AnimSampleRate 0 = no clips). 0 = cache disabled or file unreadable. */
+	NIFLIBRUNTIME_API uint64 GetMeshCacheKey(const FString& Path, int32 MaxInfluences, float AnimSampleRate);
+	/** Fill OutLODs/OutAnims from the cache without touching niflib. False on miss. */
+	NIFLIBRUNTIME_API bool LoadCachedLODs(uint64 CacheKey, TArray<FNifMeshStreams>& OutLODs, TArray<FNifAnimationData>& OutAnims);
+	/** Record freshly extracted LODs + clips under CacheKey. No-op for key 0. */
+	NIFLIBRUNTIME_API void StoreCachedLODs(uint64 CacheKey, const TArray<FNifMeshStreams>& LODs, const TArray<FNifAnimationData>& Anims);
+}
@@ -20,6 +20,7 @@ template <class T> class Ref {
 public:
 	Ref( T * object = NULL );
 	Ref(const Ref & ref_to_copy );
+	Ref( Ref && ref_to_move ) noexcept;
 
 #ifdef USE_NIFLIB_TEMPLATE_HELPERS
    template<typename U> Ref( const Ref<U>& other ) { 
@@ -47,6 +48,7 @@ public:
    friend ostream & operator<< <T>(ostream & os, const Ref & ref);
 	Ref & operator=( T * object );
 	Ref & operator=( const Ref & ref );
+	Ref & operator=( Ref && ref ) noexcept;
 	operator T*() const;
 	T* operator->() const;
 
@@ -75,6 +77,12 @@ Ref<T>::Ref(const Ref & ref_to_copy ) {
 	}
 }
 
+template <class T>
+Ref<T>::Ref( Ref && ref_to_move ) noexcept : _object(ref_to_move._object) {
+	//Take over the moved-from reference; the count does not change
+	ref_to_move._object = NULL;
+}
+
 template <class T>
 Ref<T>::~Ref() {
 	//if object insn't null, decrement reference count
@@ -147,6 +155,23 @@ Ref<T> & Ref<T>::operator=( const Ref & ref ) {
 	return *this;
 }
 
+template <class T>
+Ref<T> & Ref<T>::operator=( Ref && ref ) noexcept {
+	if ( this == &ref ) {
+		return *this; //Do nothing
+	}
+
+	//Take over the moved-from reference, then drop the one previously held, if any
+	T * previous = _object;
+	_object = ref._object;
+	ref._object = NULL;
+	if ( previous != NULL ) {
+		previous->SubtractRef();
+	}
+
+	return *this;
+}
+
 //Template functions must be in the header file
 
 template <class T>
@@ -262,6 +262,11 @@ public:
 	 */
 	NIFLIB_HIDDEN void SetParent( NiNode * new_parent );
 
+	/*!
+	 * Read-only view of the property list, without the copy GetProperties makes.  Valid while this object is alive and unmodified.
+	 */
+	const vector<Ref<NiProperty> > & GetPropertiesView() const;
+
 protected:
 	NiNode * parent;
 
@@ -310,6 +315,11 @@ public:
 };
 
 //--BEGIN FILE FOOT CUSTOM CODE--//
+
+inline const vector<Ref<NiProperty> > & NiAVObject::GetPropertiesView() const {
+	return properties;
+}
+
 //--END CUSTOM CODE--//
 
 } //End Niflib namespace
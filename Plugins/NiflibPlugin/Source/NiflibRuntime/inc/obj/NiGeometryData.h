@@ -257,6 +257,21 @@ public:
 
    NIFLIB_API SkyrimHavokMaterial GetSkyrimMaterial() const;
 
+	/*!
+	 * Frees the vertex, normal, tangent, bitangent, color and UV arrays (the storage is returned, not just cleared).  Meant for importers that have already consumed the streams; the vertex and UV set counts read 0 afterwards and the object should not be written out.
+	 */
+	void ReleaseVertexData();
+
+	/*!
+	 * Read-only views of the vertex streams, without the copies the Get* accessors make.  Valid while this object is alive and until ReleaseVertexData.
+	 */
+	const vector<Vector3> & GetVerticesView() const;
+	const vector<Vector3> & GetNormalsView() const;
+	const vector<Vector3> & GetTangentsView() const;
+	const vector<Vector3> & GetBitangentsView() const;
+	const vector<Color4> & GetColorsView() const;
+	const vector< vector<TexCoord> > & GetUVSetsView() const;
+
 private:
    unsigned short numUvSetsCalc(const NifInfo &) const;
    unsigned short bsNumUvSetsCalc(const NifInfo &) const;
@@ -353,6 +368,30 @@ public:
 };
 
 //--BEGIN FILE FOOT CUSTOM CODE--//
+
+inline void NiGeometryData::ReleaseVertexData() {
+	vector<Vector3>().swap( vertices );
+	vector<Vector3>().swap( normals );
+	vector<Vector3>().swap( tangents );
+	vector<Vector3>().swap( bitangents );
+	vector<Color4>().swap( vertexColors );
+	vector< vector<TexCoord> >().swap( uvSets );
+	numVertices = 0;
+	numUvSets = 0;
+	bsNumUvSets = 0;
+	hasVertices = false;
+	hasNormals = false;
+	hasVertexColors = false;
+	hasUv = false;
+}
+
+inline const vector<Vector3> & NiGeometryData::GetVerticesView() const { return vertices; }
+inline const vector<Vector3> & NiGeometryData::GetNormalsView() const { return normals; }
+inline const vector<Vector3> & NiGeometryData::GetTangentsView() const { return tangents; }
+inline const vector<Vector3> & NiGeometryData::GetBitangentsView() const { return bitangents; }
+inline const vector<Color4> & NiGeometryData::GetColorsView() const { return vertexColors; }
+inline const vector< vector<TexCoord> > & NiGeometryData::GetUVSetsView() const { return uvSets; }
+
 //--END CUSTOM CODE--//
 
 } //End Niflib namespace
@@ -160,6 +160,11 @@ public:
 	/*! NIFLIB_HIDDEN function.  For internal use only. */
 	NIFLIB_HIDDEN void SetSkinFlag( bool n );
 
+	/*!
+	 * Read-only view of the child list, without the copy GetChildren makes.  Valid while this node is alive and unmodified.
+	 */
+	const vector<Ref<NiAVObject> > & GetChildrenView() const;
+
 private:
 	void RepositionGeom( NiAVObjectRef root );
 protected:
@@ -189,6 +194,11 @@ public:
 };
 
 //--BEGIN FILE FOOT CUSTOM CODE--//
+
+inline const vector<Ref<NiAVObject> > & NiNode::GetChildrenView() const {
+	return children;
+}
+
 //--END CUSTOM CODE--//
 
 } //End Niflib namespace
@@ -112,6 +112,20 @@ public:
 	 */
 	NIFLIB_API void SetBoneWeights( unsigned int bone_index, const vector<SkinWeight> & weights );
 
+	/*!
+	 * Retrieves the skin weights of all bones at once, transposed to vertex-major order.  The influences of vertex v are entries offsets[v] through offsets[v+1]-1 of bones and weights, in bone order.  One counting pass and one fill pass over the bone list, without copying any bone's weight vector.
+	 * \param[in] num_vertices The vertex count of the skinned geometry.  Weights that refer to vertices at or past it are skipped.
+	 * \param[out] offsets Receives num_vertices + 1 entry offsets.
+	 * \param[out] bones Receives the bone index (as used by GetBoneWeights) of each entry.
+	 * \param[out] weights Receives the weight of each entry.
+	 */
+	void GetVertexWeights( unsigned int num_vertices, vector<unsigned int> & offsets, vector<unsigned short> & bones, vector<float> & weights ) const;
+
+	/*!
+	 * Frees the per-vertex weights of every bone (not just clears them, the storage is returned).  Bone count, bone offsets and bounding spheres are kept.  Meant for importers that have already consumed the weights; the object should not be written out afterwards.
+	 */
+	void ReleaseVertexWeights();
+
 	/*!
 	 * Returns a reference to the hardware skin partition data object, if any.
 	 * \return The hardware skin partition data, or NULL if none is used.
@@ -168,6 +182,42 @@ public:
 };
 
 //--BEGIN FILE FOOT CUSTOM CODE--//
+
+inline void NiSkinData::ReleaseVertexWeights() {
+	for ( unsigned int b = 0; b < boneList.size(); ++b ) {
+		vector<SkinWeight>().swap( boneList[b].vertexWeights );
+	}
+}
+
+inline void NiSkinData::GetVertexWeights( unsigned int num_vertices, vector<unsigned int> & offsets, vector<unsigned short> & bones, vector<float> & weights ) const {
+	offsets.assign( num_vertices + 1, 0 );
+	for ( unsigned int b = 0; b < boneList.size(); ++b ) {
+		const vector<SkinWeight> & vw = boneList[b].vertexWeights;
+		for ( unsigned int i = 0; i < vw.size(); ++i ) {
+			if ( vw[i].index < num_vertices ) {
+				++offsets[vw[i].index + 1];
+			}
+		}
+	}
+	for ( unsigned int v = 0; v < num_vertices; ++v ) {
+		offsets[v + 1] += offsets[v];
+	}
+
+	bones.resize( offsets[num_vertices] );
+	weights.resize( offsets[num_vertices] );
+	vector<unsigned int> cursor( offsets.begin(), offsets.end() - 1 );
+	for ( unsigned int b = 0; b < boneList.size(); ++b ) {
+		const vector<SkinWeight> & vw = boneList[b].vertexWeights;
+		for ( unsigned int i = 0; i < vw.size(); ++i ) {
+			if ( vw[i].index < num_vertices ) {
+				const unsigned int slot = cursor[vw[i].index]++;
+				bones[slot] = (unsigned short)b;
+				weights[slot] = vw[i].weight;
+			}
+		}
+	}
+}
+
 //--END CUSTOM CODE--//
 
 } //End Niflib namespace
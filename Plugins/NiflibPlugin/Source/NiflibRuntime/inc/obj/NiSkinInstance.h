@@ -117,6 +117,11 @@ public:
 	 */
 	NIFLIB_HIDDEN void SkeletonLost();
 
+	/*!
+	 * Read-only view of the bone list, without the Ref copy GetBones makes.  Valid while this skin instance is alive and unmodified.
+	 */
+	const vector<NiNode *> & GetBonesView() const;
+
 	//--END CUSTOM CODE--//
 protected:
 	/*! Skinning data reference. */
@@ -146,6 +151,11 @@ public:
 };
 
 //--BEGIN FILE FOOT CUSTOM CODE--//
+
+inline const vector<NiNode *> & NiSkinInstance::GetBonesView() const {
+	return bones;
+}
+
 //--END CUSTOM CODE--//
 
 } //End Niflib namespace
@@ -109,6 +109,16 @@ public:
 	 */
 	NIFLIB_API virtual void SetTriangles( const vector<Triangle> & in );
 
+	/*!
+	 * Frees the triangle list and match groups (the storage is returned, not just cleared).  Meant for importers that have already consumed them; the triangle counts read 0 afterwards and the object should not be written out.
+	 */
+	void ReleaseTriangles();
+
+	/*!
+	 * Read-only view of the stored triangles, without the copy GetTriangles makes.  Unlike GetTriangles it does not drop degenerate triangles.
+	 */
+	const vector<Triangle> & GetTrianglesView() const;
+
 private:
 	bool hasTrianglesCalc(const NifInfo & info) const {
 		return (triangles.size() > 0);
@@ -140,6 +150,20 @@ public:
 };
 
 //--BEGIN FILE FOOT CUSTOM CODE--//
+
+inline void NiTriShapeData::ReleaseTriangles() {
+	vector<Triangle>().swap( triangles );
+	vector<MatchGroup>().swap( matchGroups );
+	numTriangles = 0;
+	numTrianglePoints = 0;
+	hasTriangles = false;
+	numMatchGroups = 0;
+}
+
+inline const vector<Triangle> & NiTriShapeData::GetTrianglesView() const {
+	return triangles;
+}
+
 //--END CUSTOM CODE--//
 
 } //End Niflib namespace
@@ -111,6 +111,16 @@ public:
 	 */
 	NIFLIB_API virtual void SetTriangles( const vector<Triangle> & in );
 
+	/*!
+	 * Frees the strip point lists (the storage is returned, not just cleared).  Meant for importers that have already consumed them; the strip and triangle counts read 0 afterwards and the object should not be written out.
+	 */
+	void ReleaseStrips();
+
+	/*!
+	 * Read-only view of the strip point lists, without the per-strip copy GetStrip makes.
+	 */
+	const vector< vector<unsigned short> > & GetStripsView() const;
+
 private:
 	void SetNvTriangles( const vector<Triangle> & in );
 	void SetTSTriangles( const vector<Triangle> & in );
@@ -143,6 +153,19 @@ public:
 };
 
 //--BEGIN FILE FOOT CUSTOM CODE--//
+
+inline void NiTriStripsData::ReleaseStrips() {
+	vector< vector<unsigned short> >().swap( points );
+	vector<unsigned short>().swap( stripLengths );
+	numStrips = 0;
+	numTriangles = 0;
+	hasPoints = false;
+}
+
+inline const vector< vector<unsigned short> > & NiTriStripsData::GetStripsView() const {
+	return points;
+}
+
 //--END CUSTOM CODE--//
 
 } //End Niflib namespace
@@ -0,0 +1,291 @@
+// NifConvert <in.nif> <out.obj> [-lod N] [-copy]: headless conversion of one LOD of a .nif to a Wavefront OBJ (world
+// space, positions / normals / UV0, one usemtl per material slot). Geometry selection, LOD buckets and material slots
+// come from the same NifCore scene layer the importer uses, and the streams from the same kernels, so the OBJ holds
+// the geometry the importer would build for that LOD (OBJ keeps NIF's right-handed axes, so faces are not flipped).
+// Prints per-stage timings and heap allocation counts (including freeing the block graph) and the process's peak
+// RSS. -copy reads the geometry through niflib's copying getters instead of the in-place views, for A/B counts.
+// The counts cover this tool's own extraction loop, not the importer's; Nif.BenchExtractAllocs counts the bridge.
+
+#include "NifCore.h"
+#include "NifCoreScene.h"
+#include <niflib.h>
+#include <obj/NiObject.h>
+#include <obj/NiAVObject.h>
+#include <obj/NiGeometry.h>
+#include <obj/NiGeometryData.h>
+#include <obj/NiTriShape.h>
+#include <obj/NiTriStrips.h>
+#include <obj/NiTriShapeData.h>
+#include <obj/NiTriStripsData.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <sys/resource.h>
+
+using namespace Niflib;
+
+// Every heap allocation in the process, niflib's included (operator new is replaced program-wide)
+static std::atomic<long long> GNumAllocs{ 0 };
+
+void* operator new(std::size_t Size)
+{
+    ++GNumAllocs;
+    if (void* Ptr = std::malloc(Size ? Size : 1)) return Ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* Ptr) noexcept
+{
+    std::free(Ptr);
+}
+
+void operator delete(void* Ptr, std::size_t) noexcept
+{
+    std::free(Ptr);
+}
+
+namespace
+{
+    using FClock = std::chrono::steady_clock;
+
+    struct FObjMesh
+    {
+        std::vector<float> Positions;       // xyz per vertex
+        std::vector<float> Normals;         // xyz per vertex, zero where not authored
+        std::vector<float> UVs;             // uv per vertex, as authored (the importer does not flip V either)
+        std::vector<uint32_t> Indices;      // 3 per face, 0-based
+        std::vector<std::pair<size_t, int32_t>> MaterialRuns;  // (first face, material slot), one per geometry
+    };
+
+    static double MsSince(FClock::time_point Start)
+    {
+        return std::chrono::duration<double, std::milli>(FClock::now() - Start).count();
+    }
+
+    static double PeakRssMB()
+    {
+        rusage Usage{};
+        getrusage(RUSAGE_SELF, &Usage);
+        return Usage.ru_maxrss / 1024.0;   // KiB on Linux
+    }
+
+    static bool IsDegenerate(const Triangle& T)
+    {
+        return T.v1 == T.v2 || T.v2 == T.v3 || T.v1 == T.v3;
+    }
+
+    // One selected geometry node, the way the bridge's PlanGeometry / FillGeometry emit it
+    static bool AppendGeometry(const NifCore::FSceneIndex& Index, int32_t NodeIdx, NifCore::FMaterialTable& Materials, FObjMesh& Mesh, bool bCopy)
+    {
+        NiGeometry* Geo = Index.Nodes[NodeIdx].Geo;
+        NiGeometryDataRef Data = Geo->GetData();
+        if (!Data || Data->GetVertexCount() <= 0) return false;
+
+        const Matrix44 World = Geo->GetWorldTransform();
+        float M[4][4];
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                M[r][c] = World[r][c];
+            }
+        }
+        const NifCore::FStreamTransform Xf = NifCore::FStreamTransform::FromWorldMatrix(M);
+        const bool bFlipWinding = !Xf.bFlipWinding;    // Xf flips for UE's left-handed space; OBJ only for a mirroring matrix
+
+        // The copies only live in -copy mode; otherwise these are views into Data's own arrays
+        std::vector<Vector3> VerticesCopy, NormalsCopy;
+        std::vector<TexCoord> UV0Copy;
+        if (bCopy)
+        {
+            VerticesCopy = Data->GetVertices();
+            NormalsCopy = Data->GetNormals();
+            if (Data->GetUVSetCount() > 0) UV0Copy = Data->GetUVSet(0);
+        }
+        const std::vector<Vector3>& Vertices = bCopy ? VerticesCopy : Data->GetVerticesView();
+        const std::vector<Vector3>& Normals = bCopy ? NormalsCopy : Data->GetNormalsView();
+        const std::vector<TexCoord>& UV0 = (bCopy || Data->GetUVSetsView().empty()) ? UV0Copy : Data->GetUVSetsView()[0];
+        const int32_t NumVerts = (int32_t)Vertices.size();
+        const uint32_t Base = (uint32_t)(Mesh.Positions.size() / 3);
+
+        Mesh.Positions.resize(Mesh.Positions.size() + NumVerts * 3);
+        NifCore::TransformPositions(Xf, &Vertices[0].x, NumVerts, &Mesh.Positions[Base * 3]);
+
+        Mesh.Normals.resize(Mesh.Positions.size(), 0.f);
+        const int32_t NumNormals = std::min(NumVerts, (int32_t)Normals.size());
+        if (NumNormals > 0)
+        {
+            NifCore::TransformDirections(Xf, &Normals[0].x, NumNormals, &Mesh.Normals[Base * 3]);
+        }
+
+        Mesh.UVs.resize(Mesh.UVs.size() + NumVerts * 2, 0.f);
+        for (int32_t i = 0; i < std::min(NumVerts, (int32_t)UV0.size()); ++i)
+        {
+            Mesh.UVs[(Base + i) * 2 + 0] = UV0[i].u;
+            Mesh.UVs[(Base + i) * 2 + 1] = UV0[i].v;
+        }
+
+        std::string ConflictPath;
+        const int32_t Slot = Materials.Gather(Index, NodeIdx, ConflictPath);
+        Mesh.MaterialRuns.emplace_back(Mesh.Indices.size() / 3, Slot);
+        if (!ConflictPath.empty())
+        {
+            std::fprintf(stderr, "[NIF] Material '%s' appears with different diffuse textures: '%s' vs '%s'\n",
+                Index.Names.Names[Materials.Slots[Slot].NameId].c_str(), Materials.Slots[Slot].DiffuseTexturePath.c_str(), ConflictPath.c_str());
+        }
+
+        NiTriShapeDataRef TriData = DynamicCast<NiTriShapeData>(Data);
+        NiTriStripsDataRef StripsData = DynamicCast<NiTriStripsData>(Data);
+        if (DynamicCast<NiTriShape>(Geo) && TriData)
+        {
+            // GetTriangles() drops degenerates; the view only needs a filtered copy when there are some
+            const std::vector<Triangle>& Stored = TriData->GetTrianglesView();
+            std::vector<Triangle> Filtered;
+            if (bCopy)
+            {
+                Filtered = TriData->GetTriangles();
+            }
+            else if (std::any_of(Stored.begin(), Stored.end(), IsDegenerate))
+            {
+                Filtered.reserve(Stored.size());
+                std::remove_copy_if(Stored.begin(), Stored.end(), std::back_inserter(Filtered), IsDegenerate);
+            }
+            const std::vector<Triangle>& Tris = (bCopy || !Filtered.empty()) ? Filtered : Stored;
+            const size_t First = Mesh.Indices.size();
+            Mesh.Indices.resize(First + Tris.size() * 3);
+            NifCore::ConvertTriangles(bFlipWinding, reinterpret_cast<const uint16_t*>(Tris.data()), (int32_t)Tris.size(), Base, &Mesh.Indices[First]);
+        }
+        else if (DynamicCast<NiTriStrips>(Geo) && StripsData)
+        {
+            const std::vector<std::vector<unsigned short>>& Strips = StripsData->GetStripsView();
+            for (int s = 0; s < (int)Strips.size(); ++s)
+            {
+                const std::vector<unsigned short> StripCopy = bCopy ? StripsData->GetStrip(s) : std::vector<unsigned short>();
+                const std::vector<unsigned short>& Strip = bCopy ? StripCopy : Strips[s];
+                const size_t First = Mesh.Indices.size();
+                Mesh.Indices.resize(First + NifCore::CountStripTriangles(Strip.data(), (int32_t)Strip.size()) * 3);
+                NifCore::ConvertStrip(bFlipWinding, Strip.data(), (int32_t)Strip.size(), Base, &Mesh.Indices[First]);
+            }
+        }
+        return true;
+    }
+
+    static bool WriteObj(const char* Path, const FObjMesh& Mesh, const NifCore::FSceneIndex& Index, const NifCore::FMaterialTable& Materials)
+    {
+        FILE* File = std::fopen(Path, "w");
+        if (!File) return false;
+
+        const size_t NumVerts = Mesh.Positions.size() / 3;
+        for (size_t i = 0; i < NumVerts; ++i)
+            std::fprintf(File, "v %g %g %g\n", Mesh.Positions[i * 3], Mesh.Positions[i * 3 + 1], Mesh.Positions[i * 3 + 2]);
+        for (size_t i = 0; i < NumVerts; ++i)
+            std::fprintf(File, "vn %g %g %g\n", Mesh.Normals[i * 3], Mesh.Normals[i * 3 + 1], Mesh.Normals[i * 3 + 2]);
+        for (size_t i = 0; i < NumVerts; ++i)
+            std::fprintf(File, "vt %g %g\n", Mesh.UVs[i * 2], Mesh.UVs[i * 2 + 1]);
+        size_t NextRun = 0;
+        for (size_t f = 0; f + 2 < Mesh.Indices.size(); f += 3)
+        {
+            for (; NextRun < Mesh.MaterialRuns.size() && Mesh.MaterialRuns[NextRun].first <= f / 3; ++NextRun)
+            {
+                std::fprintf(File, "usemtl %s\n", Index.Names.Names[Materials.Slots[Mesh.MaterialRuns[NextRun].second].NameId].c_str());
+            }
+            const uint32_t A = Mesh.Indices[f] + 1, B = Mesh.Indices[f + 1] + 1, C = Mesh.Indices[f + 2] + 1;
+            std::fprintf(File, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", A, A, A, B, B, B, C, C, C);
+        }
+        return std::fclose(File) == 0;
+    }
+}
+
+int main(int Argc, char** Argv)
+{
+    if (Argc < 3)
+    {
+        std::fprintf(stderr, "Usage: NifConvert <in.nif> <out.obj> [-lod N] [-copy]\n");
+        return 2;
+    }
+    bool bCopy = false;
+    int32_t RequestedLOD = 0;
+    for (int i = 3; i < Argc; ++i)
+    {
+        if (std::strcmp(Argv[i], "-copy") == 0) bCopy = true;
+        else if (std::strcmp(Argv[i], "-lod") == 0 && i + 1 < Argc) RequestedLOD = std::atoi(Argv[++i]);
+    }
+
+    long long AllocsBefore = GNumAllocs.load();
+    FClock::time_point Start = FClock::now();
+    NifInfo Info;
+    std::vector<NiObjectRef> Blocks;
+    try
+    {
+        Blocks = ReadNifList(Argv[1], &Info);
+    }
+    catch (const std::exception& Ex)
+    {
+        std::fprintf(stderr, "[NIF] Could not read %s: %s\n", Argv[1], Ex.what());
+        return 1;
+    }
+    const double ReadMs = MsSince(Start);
+    const long long ReadAllocs = GNumAllocs.load() - AllocsBefore;
+
+    AllocsBefore = GNumAllocs.load();
+    Start = FClock::now();
+    NifCore::FSceneIndex Index;
+    NifCore::BuildSceneIndex(Blocks, std::vector<std::string>(), &NifCore::NiflibIsDerived, Index);
+    NifCore::FLODSelection Selection;
+    if (!NifCore::SelectLODGeometries(Index, RequestedLOD, Selection))
+    {
+        std::fprintf(stderr, "[NIF][LOD] %s: no non-shadow NiTriShape/NiTriStrips for LOD%d\n", Argv[1], RequestedLOD);
+        return 1;
+    }
+    if (Selection.Bucket != NifCore::NoIndex && Selection.Bucket != RequestedLOD)
+    {
+        std::fprintf(stderr, "[NIF][LOD] RequestedLOD=%d out of range; clamped to %d\n", RequestedLOD, Selection.Bucket);
+    }
+    for (int32_t Child : Selection.EmptyChildren)
+    {
+        std::fprintf(stderr, "[NIF][LOD] No non-shadow TriShape/TriStrips found under child '%s'\n",
+            Index.Names.Names[Index.Nodes[Child].NameId].c_str());
+    }
+
+    FObjMesh Mesh;
+    NifCore::FMaterialTable Materials;
+    std::unordered_set<const NiGeometryData*> VisitedData;     // the importer emits shared data once, too
+    int NumGeometries = 0;
+    for (int32_t NodeIdx : Selection.GeoNodes)
+    {
+        if (!VisitedData.insert(Index.Nodes[NodeIdx].Geo->GetData()).second) continue;
+        NumGeometries += AppendGeometry(Index, NodeIdx, Materials, Mesh, bCopy) ? 1 : 0;
+    }
+    const double ConvertMs = MsSince(Start);
+    const long long ConvertAllocs = GNumAllocs.load() - AllocsBefore;
+
+    Start = FClock::now();
+    if (!WriteObj(Argv[2], Mesh, Index, Materials))
+    {
+        std::fprintf(stderr, "[NIF] Could not write %s\n", Argv[2]);
+        return 1;
+    }
+    const double WriteMs = MsSince(Start);
+
+    const size_t NumBlocks = Blocks.size();
+    const int32_t NumLODs = Index.AuthoredLODCount;
+    Start = FClock::now();
+    Index = NifCore::FSceneIndex();
+    Blocks.clear();
+    const double FreeMs = MsSince(Start);
+
+    std::printf("[NIF][Perf] %s: Blocks=%zu LOD=%d/%d Geometries=%d Materials=%zu Verts=%zu Faces=%zu Read=%.3f ms Convert=%.3f ms Write=%.3f ms Free=%.3f ms PeakRSS=%.1f MB\n",
+        Argv[1], NumBlocks, Selection.Bucket == NifCore::NoIndex ? 0 : Selection.Bucket, NumLODs, NumGeometries,
+        Materials.Slots.size(), Mesh.Positions.size() / 3, Mesh.Indices.size() / 3, ReadMs, ConvertMs, WriteMs, FreeMs, PeakRssMB());
+    std::printf("[NIF][Perf] %s: Allocs Read=%lld Convert=%lld (%s)\n",
+        Argv[1], ReadAllocs, ConvertAllocs, bCopy ? "copying getters" : "views");
+    return 0;
+}
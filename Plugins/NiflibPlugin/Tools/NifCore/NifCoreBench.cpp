@@ -0,0 +1,114 @@
+// NifCoreBench [NumVerts] [Iterations]: the conversion core's hot kernels on synthetic data, for profiling
+// outside the editor (perf, VTune, ...). Same workloads as the editor's Nif.BenchVertexKernels.
+
+#include "NifCore.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using FClock = std::chrono::steady_clock;
+
+    template <typename FnType>
+    static double TimeMs(int Iterations, FnType&& Fn)
+    {
+        const FClock::time_point Start = FClock::now();
+        for (int It = 0; It < Iterations; ++It)
+        {
+            Fn();
+        }
+        return std::chrono::duration<double, std::milli>(FClock::now() - Start).count() / Iterations;
+    }
+}
+
+int main(int Argc, char** Argv)
+{
+    const int NumVerts = std::max(1, Argc > 1 ? std::atoi(Argv[1]) : 1000000);
+    const int Iterations = std::max(1, Argc > 2 ? std::atoi(Argv[2]) : 20);
+
+    std::mt19937 Rng(0x4E4946);
+    std::uniform_real_distribution<float> Coord(-100.f, 100.f);
+    std::uniform_real_distribution<float> Unit(-1.f, 1.f);
+
+    std::vector<float> InPos(NumVerts * 3), InNrm(NumVerts * 3), OutPos(NumVerts * 3), OutNrm(NumVerts * 3);
+    for (int i = 0; i < NumVerts * 3; ++i)
+    {
+        InPos[i] = Coord(Rng);
+        InNrm[i] = Unit(Rng);
+    }
+
+    // Rotation about z by 45 degrees, uniform scale 1.5, some translation
+    const float C = 1.5f * std::cos(0.785398f), S = 1.5f * std::sin(0.785398f);
+    const float World[4][4] = { { C, S, 0, 0 }, { -S, C, 0, 0 }, { 0, 0, 1.5f, 0 }, { 12.f, -3.f, 7.5f, 1 } };
+    const NifCore::FStreamTransform Xf = NifCore::FStreamTransform::FromWorldMatrix(World);
+
+    const double VertexMs = TimeMs(Iterations, [&]()
+    {
+        NifCore::TransformPositions(Xf, InPos.data(), NumVerts, OutPos.data());
+        NifCore::TransformDirections(Xf, InNrm.data(), NumVerts, OutNrm.data());
+    });
+    std::printf("[NIF][Perf] Vertex kernels, %d verts x %d: %.3f ms (%.1f Mverts/s)\n",
+        NumVerts, Iterations, VertexMs, NumVerts / std::max(VertexMs * 1000.0, 1e-6));
+
+    // Strips: a grid-like strip over the same vertex count, restarted with degenerates every 64 indices
+    std::vector<uint16_t> Strip;
+    Strip.reserve(NumVerts + NumVerts / 32);
+    for (int i = 0; i < NumVerts; ++i)
+    {
+        Strip.push_back((uint16_t)(i & 0xFFFF));
+        if ((i & 63) == 63)
+        {
+            Strip.push_back((uint16_t)(i & 0xFFFF));
+            Strip.push_back((uint16_t)((i + 1) & 0xFFFF));
+        }
+    }
+    std::vector<uint32_t> Indices;
+    const double StripMs = TimeMs(Iterations, [&]()
+    {
+        Indices.resize(NifCore::CountStripTriangles(Strip.data(), (int32_t)Strip.size()) * 3);
+        NifCore::ConvertStrip(true, Strip.data(), (int32_t)Strip.size(), 0, Indices.data());
+    });
+    std::printf("[NIF][Perf] Strip kernel, %d indices x %d: %.3f ms (%zu triangles)\n",
+        (int)Strip.size(), Iterations, StripMs, Indices.size() / 3);
+
+    // Skin: 4 source weights per vertex over 64 bones, packed into 8 slots then normalized
+    const int NumBones = 64, PerVertex = 4, K = 8;
+    std::vector<uint32_t> Offsets(NumVerts + 1);
+    std::vector<uint16_t> EntryBones(NumVerts * PerVertex);
+    std::vector<float> EntryWeights(NumVerts * PerVertex);
+    std::uniform_int_distribution<int> AnyBone(0, NumBones - 1);
+    std::uniform_real_distribution<float> AnyWeight(0.f, 1.f);
+    for (int v = 0; v < NumVerts; ++v)
+    {
+        Offsets[v + 1] = Offsets[v] + PerVertex;
+        for (int e = 0; e < PerVertex; ++e)
+        {
+            EntryBones[v * PerVertex + e] = (uint16_t)AnyBone(Rng);
+            EntryWeights[v * PerVertex + e] = AnyWeight(Rng);
+        }
+    }
+    std::vector<int32_t> BoneMap(NumBones);
+    for (int b = 0; b < NumBones; ++b)
+    {
+        BoneMap[b] = b;
+    }
+    std::vector<int32_t> SlotBones(NumVerts * K);
+    std::vector<float> SlotWeights(NumVerts * K);
+    int32_t Dropped = 0;
+    const double SkinMs = TimeMs(Iterations, [&]()
+    {
+        std::fill(SlotBones.begin(), SlotBones.end(), NifCore::NoBone);
+        std::fill(SlotWeights.begin(), SlotWeights.end(), 0.f);
+        NifCore::PackSkinInfluences(Offsets.data(), EntryBones.data(), EntryWeights.data(), NumVerts,
+            BoneMap.data(), NumBones, NumBones, K, SlotBones.data(), SlotWeights.data());
+        Dropped = NifCore::NormalizeInfluences(SlotBones.data(), SlotWeights.data(), NumVerts, K, NumBones, 0);
+    });
+    std::printf("[NIF][Perf] Skin pack + normalize, %d verts x %d: %.3f ms (%.1f ns/vert, dropped %d)\n",
+        NumVerts, Iterations, SkinMs, SkinMs * 1.0e6 / NumVerts, Dropped);
+    return 0;
+}
@@ -4,10 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
-//#include "ProceduralMeshComponent.h"
-//#include "obj/NiNode.h"
 #include "NifTestGameMode.generated.h"
 
+class UProceduralMeshComponent;
+
 UCLASS()
 class NIFTEST_API ANifTestGameMode : public AGameModeBase
 {
@@ -16,8 +16,14 @@ class NIFTEST_API ANifTestGameMode : public AGameModeBase
 public:
 	virtual void BeginPlay() override;
 
+	/** .nif files streamed in at BeginPlay through UNifAsyncLoader (one actor each, spaced along X). */
+	UPROPERTY(EditAnywhere, Category = "NIF Test")
+	TArray<FString> NifPaths;
+
+	/** LOD bucket to load from each file. */
+	UPROPERTY(EditAnywhere, Category = "NIF Test")
+	int32 RequestedLOD = 0;
+
 private:
-	// virtual void TraverseNifNodes(Niflib::NiObjectRef node, int depth = 0);
-	// virtual void ShowProceduralMesh(const TArray<FVector>& Positions, const TArray<int32>& Triangles, const TArray<FVector2D>& UVs);
-	// bool bSpawnedMesh = false;
+	void OnNifMeshLoaded(UProceduralMeshComponent* Component, FString Path);
 };